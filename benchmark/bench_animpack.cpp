@@ -0,0 +1,179 @@
+// PackedAnimation: size and quality of compressed animation samples against raw data.
+// Usage: bench_animpack [file.man ...]
+//
+// Reports memory (raw/packed), kept keys, constant tracks, max/avg rotation (degrees) and position error
+// and decode time per frame. Exits with 1, if error of any frame exceeds tolerance.
+// Without files, synthetic skeleton with constant, smooth and noisy tracks is used.
+
+#include <zenkit/ModelAnimation.hh>
+#include <zenkit/Stream.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graphics/mesh/packedanimation.h"
+
+struct Clip {
+  std::string                          name;
+  uint32_t                             numFrames = 0;
+  uint32_t                             numNodes  = 0;
+  std::vector<zenkit::AnimationSample> samples;
+  };
+
+static void setRotation(zenkit::AnimationSample& s, float ax, float ay, float az) {
+  // euler xyz to quaternion
+  const float cx = std::cos(ax*0.5f), sx = std::sin(ax*0.5f);
+  const float cy = std::cos(ay*0.5f), sy = std::sin(ay*0.5f);
+  const float cz = std::cos(az*0.5f), sz = std::sin(az*0.5f);
+  s.rotation.w = cx*cy*cz + sx*sy*sz;
+  s.rotation.x = sx*cy*cz - cx*sy*sz;
+  s.rotation.y = cx*sy*cz + sx*cy*sz;
+  s.rotation.z = cx*cy*sz - sx*sy*cz;
+  }
+
+static Clip mkClip(uint32_t numFrames, uint32_t numNodes) {
+  std::mt19937                          rng(42);
+  std::uniform_real_distribution<float> d(-1.f,1.f);
+
+  Clip c;
+  c.name      = "synthetic";
+  c.numFrames = numFrames;
+  c.numNodes  = numNodes;
+  c.samples.resize(size_t(numFrames)*numNodes);
+
+  for(uint32_t n=0; n<numNodes; ++n) {
+    const float phase = d(rng)*3.f, amp = d(rng), base = d(rng)*20.f;
+    for(uint32_t f=0; f<numFrames; ++f) {
+      auto&       s = c.samples[size_t(f)*numNodes+n];
+      const float t = float(f)/30.f;
+      switch(n%3) {
+        case 0: // constant
+          setRotation(s,phase,amp,0.f);
+          s.position = {base,0.f,0.f};
+          break;
+        case 1: // smooth
+          setRotation(s,amp*std::sin(t*2.f+phase),amp*std::cos(t*3.f),0.f);
+          s.position = {base,0.f,0.f};
+          break;
+        case 2: // noisy, root motion
+          setRotation(s,amp*std::sin(t*7.f+phase)+d(rng)*0.02f,d(rng)*0.02f,amp*std::cos(t*5.f));
+          s.position = {base+t*300.f,std::sin(t*9.f)*5.f,d(rng)*0.5f};
+          break;
+        }
+      }
+    }
+  return c;
+  }
+
+static bool loadClip(Clip& c, const std::string& path) {
+  try {
+    auto                   buf = zenkit::Read::from(path);
+    zenkit::ModelAnimation p;
+    p.load(buf.get());
+    c.name      = path;
+    c.numNodes  = uint32_t(p.node_indices.size());
+    c.numFrames = c.numNodes>0 ? uint32_t(std::min<size_t>(p.frame_count,p.samples.size()/c.numNodes)) : 0;
+    c.samples   = std::move(p.samples);
+    return c.numFrames>0;
+    }
+  catch(const std::exception& e) {
+    std::printf("unable to load \"%s\": %s\n", path.c_str(), e.what());
+    return false;
+    }
+  }
+
+// angle between rotations, in degrees
+static double angle(const zenkit::AnimationSample& a, const zenkit::AnimationSample& b) {
+  double qa[4] = {a.rotation.x, a.rotation.y, a.rotation.z, a.rotation.w};
+  double qb[4] = {b.rotation.x, b.rotation.y, b.rotation.z, b.rotation.w};
+  double la = 0, lb = 0, dt = 0;
+  for(int i=0; i<4; ++i) {
+    la += qa[i]*qa[i];
+    lb += qb[i]*qb[i];
+    dt += qa[i]*qb[i];
+    }
+  la = std::sqrt(la);
+  lb = std::sqrt(lb);
+  double chord = 0;
+  for(int i=0; i<4; ++i) {
+    double d = qa[i]/la - (dt<0 ? -qb[i] : qb[i])/lb;
+    chord += d*d;
+    }
+  return 4.0*std::asin(std::min(1.0,std::sqrt(chord)*0.5))*180.0/M_PI;
+  }
+
+static bool report(const Clip& c, const PackedAnimation::Tolerance& tol) {
+  auto t0 = std::chrono::steady_clock::now();
+  PackedAnimation pk(c.samples.data(),c.numFrames,c.numNodes,tol);
+  auto t1 = std::chrono::steady_clock::now();
+  if(pk.isEmpty()) {
+    std::printf("%s: not packed\n", c.name.c_str());
+    return false;
+    }
+
+  std::vector<zenkit::AnimationSample> frame(c.numNodes);
+  double maxRot = 0, sumRot = 0, maxPos = 0, sumPos = 0;
+  for(uint32_t f=0; f<c.numFrames; ++f) {
+    pk.sample(frame.data(),f,c.numNodes);
+    for(uint32_t n=0; n<c.numNodes; ++n) {
+      auto& r = c.samples[size_t(f)*c.numNodes+n];
+      auto& s = frame[n];
+      double rot = angle(r,s);
+      double dx  = r.position.x-s.position.x, dy = r.position.y-s.position.y, dz = r.position.z-s.position.z;
+      double pos = std::sqrt(dx*dx + dy*dy + dz*dz);
+      maxRot  = std::max(maxRot,rot);
+      maxPos  = std::max(maxPos,pos);
+      sumRot += rot;
+      sumPos += pos;
+      }
+    }
+
+  const int repeat = 200;
+  auto      t2     = std::chrono::steady_clock::now();
+  for(int i=0; i<repeat; ++i)
+    for(uint32_t f=0; f<c.numFrames; ++f)
+      pk.sample(frame.data(),f,c.numNodes);
+  auto t3 = std::chrono::steady_clock::now();
+
+  const auto   st      = pk.stats();
+  const size_t raw     = c.samples.size()*sizeof(zenkit::AnimationSample);
+  const size_t packed  = pk.memoryUsage();
+  const double cnt     = double(c.samples.size());
+  const double decode  = std::chrono::duration<double,std::nano>(t3-t2).count()/double(repeat*c.numFrames);
+
+  std::printf("%s: %u frames, %u nodes\n", c.name.c_str(), c.numFrames, c.numNodes);
+  std::printf("  memory: raw %zu, packed %zu bytes (%.1f%%)\n", raw, packed, double(packed)*100.0/double(raw));
+  std::printf("  keys: %zu/%zu (%.1f%%), const tracks: %zu/%zu\n", st.keys, st.rawKeys,
+              double(st.keys)*100.0/double(st.rawKeys), st.constTracks, st.tracks);
+  std::printf("  error: rotation max %.4f avg %.4f deg, position max %.4f avg %.4f\n",
+              maxRot, sumRot/cnt, maxPos, sumPos/cnt);
+  std::printf("  pack: %.2f ms, decode: %.1f ns/frame\n",
+              std::chrono::duration<double,std::milli>(t1-t0).count(), decode);
+
+  // small slack for float math in error evaluation
+  return maxRot<=tol.rotation*1.01 && maxPos<=tol.position*1.01;
+  }
+
+int main(int argc, char** argv) {
+  std::vector<Clip> clips;
+  for(int i=1; i<argc; ++i) {
+    Clip c;
+    if(loadClip(c,argv[i]))
+      clips.push_back(std::move(c));
+    }
+  if(argc<=1)
+    clips.push_back(mkClip(240,60));
+
+  PackedAnimation::Tolerance tol;
+  bool ok = true;
+  for(auto& c:clips)
+    ok &= report(c,tol);
+  if(!ok)
+    std::printf("error exceeds tolerance (rotation %.3f deg, position %.3f)\n", tol.rotation, tol.position);
+  return ok ? 0 : 1;
+  }
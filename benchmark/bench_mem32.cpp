@@ -0,0 +1,147 @@
+// Ikarus Mem32: replay of a memory access trace (alloc/free/realloc/read/write).
+// Usage: bench_mem32 [trace-file|-] [repeat]
+//
+// Trace is a text file, one operation per line; block ids are trace-local, addresses are assigned on replay:
+//   a <id> <size>          - MEM_Alloc
+//   f <id>                 - MEM_Free
+//   r <id> <offset>        - MEM_ReadInt
+//   w <id> <offset>        - MEM_WriteInt
+//   e <id> <size>          - MEM_Realloc
+// Without a trace file (or with '-'), a synthetic trace modeled after LeGo (many small long-living objects,
+// bursts of accesses to the same object) is generated.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "game/compatibility/mem32.h"
+
+struct Op {
+  char     type   = 0;
+  uint32_t id     = 0;
+  uint32_t arg    = 0;
+  };
+
+static std::vector<Op> loadTrace(const char* path) {
+  std::vector<Op> ret;
+  std::ifstream   fin(path);
+  char            type = 0;
+  while(fin >> type) {
+    Op op;
+    op.type = type;
+    fin >> op.id;
+    if(type!='f')
+      fin >> op.arg;
+    ret.push_back(op);
+    }
+  return ret;
+  }
+
+static std::vector<Op> mkTrace(size_t count) {
+  std::mt19937    rng(42);
+  std::vector<Op> ret;
+  std::vector<std::pair<uint32_t,uint32_t>> live; // id, size
+  uint32_t        nextId = 0;
+
+  auto alloc = [&]() {
+    uint32_t sz = 16 + (rng()%32)*8;
+    if(rng()%16==0)
+      sz = 1024 + rng()%4096;
+    ret.push_back({'a',nextId,sz});
+    live.emplace_back(nextId,sz);
+    ++nextId;
+    };
+
+  for(size_t i=0; i<20000; ++i)
+    alloc();
+
+  while(ret.size()<count) {
+    const uint32_t r = rng()%100;
+    if(r<2) {
+      alloc();
+      }
+    else if(r<4) {
+      size_t id = rng()%live.size();
+      ret.push_back({'f',live[id].first,0});
+      live[id] = live.back();
+      live.pop_back();
+      }
+    else if(r<5) {
+      auto& obj = live[rng()%live.size()];
+      obj.second += 8*(1+rng()%8);
+      ret.push_back({'e',obj.first,obj.second});
+      }
+    else {
+      // burst of field accesses to one object
+      auto&    obj   = live[rng()%live.size()];
+      uint32_t burst = 4 + rng()%28;
+      for(uint32_t b=0; b<burst; ++b) {
+        uint32_t off = (rng()%(obj.second/4))*4;
+        ret.push_back({(rng()%4==0) ? 'w' : 'r',obj.first,off});
+        }
+      }
+    }
+  return ret;
+  }
+
+static double replay(const std::vector<Op>& trace, int64_t& checksum) {
+  Mem32                                  mem;
+  std::unordered_map<uint32_t,uint32_t>  addr;
+  addr.reserve(trace.size()/8);
+
+  auto t0 = std::chrono::steady_clock::now();
+  for(auto& op:trace) {
+    switch(op.type) {
+      case 'a':
+        addr[op.id] = mem.alloc(op.arg);
+        break;
+      case 'f':
+        mem.free(addr[op.id]);
+        addr.erase(op.id);
+        break;
+      case 'e':
+        addr[op.id] = mem.realloc(addr[op.id],op.arg);
+        break;
+      case 'r':
+        checksum += mem.readInt(addr[op.id]+op.arg);
+        break;
+      case 'w':
+        mem.writeInt(addr[op.id]+op.arg,int32_t(op.id));
+        break;
+      }
+    }
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double,std::milli>(t1-t0).count();
+  }
+
+int main(int argc, char** argv) {
+  const bool      synth  = argc<2 || std::string_view(argv[1])=="-";
+  std::vector<Op> trace  = synth ? mkTrace(10000000) : loadTrace(argv[1]);
+  int             repeat = argc>2 ? std::atoi(argv[2]) : 5;
+  if(trace.empty()) {
+    std::printf("empty trace\n");
+    return 1;
+    }
+
+  size_t count[128] = {};
+  for(auto& op:trace)
+    count[uint8_t(op.type)&0x7F]++;
+  std::printf("ops: %zu (alloc %zu, free %zu, realloc %zu, read %zu, write %zu)\n",
+              trace.size(),count['a'],count['f'],count['e'],count['r'],count['w']);
+
+  double  best     = 0;
+  int64_t checksum = 0;
+  for(int i=0; i<repeat; ++i) {
+    double t = replay(trace,checksum);
+    if(i==0 || t<best)
+      best = t;
+    }
+  std::printf("replay: %.2f ms, %.1f ns/op (checksum %lld)\n",
+              best, best*1e6/double(trace.size()), (long long)checksum);
+  return 0;
+  }
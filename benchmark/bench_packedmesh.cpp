@@ -0,0 +1,175 @@
+// PackedMesh: meshlet packing of a world mesh or a multi-resolution mesh.
+// Usage: bench_packedmesh [file.zen|file.mrm|-] [repeat] [g1|g2]
+//
+// Reports packing time, meshlet fill rate (primitives and vertices, relative to MaxPrim/MaxVert)
+// and bounds tightness: cluster-sphere radius relative to half of meshlet aabb diagonal (lower is tighter).
+// Bounds are only reported for world meshes, objects don't store cluster spheres.
+// Without a file (or with '-'), synthetic terrain with uv-seams and a few materials is packed.
+
+#include <zenkit/Stream.hh>
+#include <zenkit/World.hh>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "graphics/mesh/submesh/packedmesh.h"
+
+using namespace Tempest;
+
+static zenkit::Mesh mkTerrain(uint32_t n) {
+  std::mt19937 rng(42);
+  zenkit::Mesh mesh;
+  mesh.materials.resize(4);
+  for(size_t i=0; i<mesh.materials.size(); ++i)
+    mesh.materials[i].texture = "TERRAIN_" + std::to_string(i) + ".TGA";
+
+  for(uint32_t y=0; y<=n; ++y)
+    for(uint32_t x=0; x<=n; ++x) {
+      mesh.vertices.push_back({float(x)*200.f, float(rng()%100), float(y)*200.f});
+      for(int seam=0; seam<2; ++seam) {
+        decltype(mesh.features)::value_type f = {};
+        f.texture = {float(x)*0.25f + float(seam), float(y)*0.25f};
+        f.normal  = {0.f, 1.f, 0.f};
+        mesh.features.push_back(f);
+        }
+      }
+
+  std::vector<std::array<uint32_t,4>> tri; // a, b, c, material
+  for(uint32_t y=0; y<n; ++y)
+    for(uint32_t x=0; x<n; ++x) {
+      const uint32_t a   = y*(n+1)+x, b = a+1, c = a+n+1, d = c+1;
+      const uint32_t mat = ((x/32) + (y/32)*3)%uint32_t(mesh.materials.size());
+      tri.push_back({a,b,c,mat});
+      tri.push_back({b,d,c,mat});
+      }
+  std::shuffle(tri.begin(), tri.end(), rng);
+
+  for(auto& t:tri) {
+    for(int i=0; i<3; ++i) {
+      const uint32_t x    = t[i]%(n+1), y = t[i]/(n+1);
+      const uint32_t seam = ((x/7) + (y/5))%2;
+      mesh.polygons.vertex_indices .push_back(t[i]);
+      mesh.polygons.feature_indices.push_back(t[i]*2+seam);
+      }
+    mesh.polygons.material_indices.push_back(t[3]);
+    }
+  return mesh;
+  }
+
+struct Stats {
+  size_t meshlets = 0;
+  size_t prim     = 0;
+  size_t vert     = 0;
+  double radius   = 0;
+  double tight    = 0;
+  };
+
+static Stats stats(const PackedMesh& pm) {
+  Stats st;
+  const auto& ibo = pm.indices;
+  st.meshlets = ibo.size()/PackedMesh::MaxInd;
+
+  std::unordered_set<uint32_t> used;
+  for(size_t m=0; m<st.meshlets; ++m) {
+    const uint32_t* ind = &ibo[m*PackedMesh::MaxInd];
+    Vec3 bmin, bmax;
+    used.clear();
+    for(size_t i=0; i<PackedMesh::MaxInd; i+=3) {
+      if(ind[i]==ind[i+1] && ind[i]==ind[i+2])
+        continue; // padding
+      st.prim++;
+      for(size_t r=0; r<3; ++r) {
+        if(!used.insert(ind[i+r]).second)
+          continue;
+        const float* p = pm.vertices.empty() ? pm.verticesA[ind[i+r]].pos[0] : pm.vertices[ind[i+r]].pos;
+        const Vec3   v = {p[0],p[1],p[2]};
+        if(used.size()==1) {
+          bmin = v;
+          bmax = v;
+          }
+        bmin = Vec3(std::min(bmin.x,v.x), std::min(bmin.y,v.y), std::min(bmin.z,v.z));
+        bmax = Vec3(std::max(bmax.x,v.x), std::max(bmax.y,v.y), std::max(bmax.z,v.z));
+        }
+      }
+    st.vert += used.size();
+
+    if(m<pm.meshletBounds.size()) {
+      const float r    = pm.meshletBounds[m].r;
+      const float half = (bmax-bmin).length()*0.5f;
+      st.radius += r;
+      st.tight  += half>0 ? r/half : 1.0;
+      }
+    }
+  return st;
+  }
+
+int main(int argc, char** argv) {
+  const std::string_view path   = argc>1 ? argv[1] : "-";
+  const int              repeat = argc>2 ? std::atoi(argv[2]) : 5;
+  const auto             ver    = (argc>3 && std::string_view(argv[3])=="g1") ? zenkit::GameVersion::GOTHIC_1
+                                                                               : zenkit::GameVersion::GOTHIC_2;
+  const bool             isMrm  = path.size()>4 && (path.substr(path.size()-4)==".MRM" || path.substr(path.size()-4)==".mrm");
+
+  zenkit::Mesh                land;
+  zenkit::MultiResolutionMesh mrm;
+  size_t                      triCount = 0;
+  try {
+    if(path=="-") {
+      land     = mkTerrain(512);
+      triCount = land.polygons.material_indices.size();
+      }
+    else if(isMrm) {
+      auto buf = zenkit::Read::from(std::string(path));
+      mrm.load(buf.get());
+      for(auto& sm:mrm.sub_meshes)
+        triCount += sm.triangles.size();
+      }
+    else {
+      auto          buf = zenkit::Read::from(std::string(path));
+      zenkit::World world;
+      world.load(buf.get(), ver);
+      land     = std::move(world.world_mesh);
+      triCount = land.polygons.material_indices.size();
+      }
+    }
+  catch(const std::exception& e) {
+    std::printf("unable to load \"%s\": %s\n", std::string(path).c_str(), e.what());
+    return 1;
+    }
+
+  std::printf("triangles: %zu\n", triCount);
+
+  double     best = 0;
+  PackedMesh pm;
+  for(int i=0; i<repeat; ++i) {
+    auto t0 = std::chrono::steady_clock::now();
+    pm = isMrm ? PackedMesh(mrm,PackedMesh::PK_Visual) : PackedMesh(land,PackedMesh::PK_VisualLnd);
+    auto t1 = std::chrono::steady_clock::now();
+    double t = std::chrono::duration<double,std::milli>(t1-t0).count();
+    if(i==0 || t<best)
+      best = t;
+    }
+
+  const Stats st = stats(pm);
+  if(st.meshlets==0) {
+    std::printf("no meshlets\n");
+    return 1;
+    }
+  std::printf("pack: %.2f ms, %.1f ns/triangle\n", best, best*1e6/double(std::max<size_t>(triCount,1)));
+  std::printf("meshlets: %zu, fill: prim %.1f%%, vert %.1f%%\n", st.meshlets,
+              double(st.prim)*100.0/double(st.meshlets*PackedMesh::MaxPrim),
+              double(st.vert)*100.0/double(st.meshlets*PackedMesh::MaxVert));
+  if(!pm.meshletBounds.empty())
+    std::printf("bounds: avg radius %.1f, radius/half-aabb-diagonal %.3f\n",
+                st.radius/double(pm.meshletBounds.size()), st.tight/double(pm.meshletBounds.size()));
+  return 0;
+  }
@@ -0,0 +1,108 @@
+// Pose evaluation: scalar (mix + mkMatrix + Matrix4x4::operator*) vs batched simd kernels.
+// Usage: bench_pose [skeletons] [bones] [iterations]
+
+#include <Tempest/Matrix4x4>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "graphics/mesh/animmath.h"
+
+using namespace Tempest;
+
+struct Skeleton {
+  std::vector<zenkit::AnimationSample> frameA, frameB;
+  std::vector<size_t>                  parent;
+  };
+
+static zenkit::AnimationSample mkSample(std::mt19937& rng) {
+  std::uniform_real_distribution<float> d(-1.f,1.f);
+  zenkit::AnimationSample s = {};
+  s.rotation = glm::normalize(glm::quat(d(rng),d(rng),d(rng),d(rng)));
+  s.position = glm::vec3(d(rng),d(rng),d(rng))*10.f;
+  return s;
+  }
+
+static void evalScalar(const Skeleton& sk, float a, Matrix4x4* tr) {
+  const Matrix4x4 root = Matrix4x4::mkIdentity();
+  for(size_t i=0; i<sk.parent.size(); ++i) {
+    auto smp = mix(sk.frameA[i],sk.frameB[i],a);
+    auto mat = mkMatrix(smp);
+    size_t p = sk.parent[i];
+    tr[i] = (p<i ? tr[p] : root)*mat;
+    }
+  }
+
+static void evalBatched(const Skeleton& sk, float a, Matrix4x4* tr) {
+  const Matrix4x4 root  = Matrix4x4::mkIdentity();
+  const size_t    count = sk.parent.size();
+
+  std::vector<zenkit::AnimationSample> smp(count);
+  std::vector<Matrix4x4>               local(count);
+  mixSamples(smp.data(),sk.frameA.data(),sk.frameB.data(),a,count);
+  mkMatrices(local.data(),smp.data(),count);
+  for(size_t i=0; i<count; ++i) {
+    size_t p = sk.parent[i];
+    mulMatrix(tr[i],p<i ? tr[p] : root,local[i]);
+    }
+  }
+
+template<class F>
+static double measure(F f, size_t iterations) {
+  auto t0 = std::chrono::steady_clock::now();
+  for(size_t i=0; i<iterations; ++i)
+    f(i);
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double,std::milli>(t1-t0).count();
+  }
+
+int main(int argc, const char** argv) {
+  const size_t skeletons  = argc>1 ? size_t(std::atoi(argv[1])) : 128;
+  const size_t bones      = argc>2 ? size_t(std::atoi(argv[2])) : 60;
+  const size_t iterations = argc>3 ? size_t(std::atoi(argv[3])) : 200;
+
+  std::mt19937 rng(42);
+  std::vector<Skeleton> sk(skeletons);
+  for(auto& s:sk) {
+    for(size_t i=0; i<bones; ++i) {
+      // adjacent keyframes are close to each other
+      auto a = mkSample(rng);
+      auto b = a;
+      b.rotation = glm::normalize(b.rotation + glm::quat(0.02f,0.01f,-0.02f,0.01f));
+      b.position += glm::vec3(0.5f);
+      s.frameA.push_back(a);
+      s.frameB.push_back(b);
+      s.parent.push_back(i==0 ? size_t(-1) : size_t(rng()%i));
+      }
+    }
+
+  std::vector<Matrix4x4> trS(bones), trB(bones);
+  float maxErr = 0;
+  for(auto& s:sk) {
+    evalScalar (s,0.37f,trS.data());
+    evalBatched(s,0.37f,trB.data());
+    for(size_t i=0; i<bones; ++i)
+      for(int c=0; c<4; ++c)
+        for(int r=0; r<4; ++r)
+          maxErr = std::max(maxErr,std::abs(trS[i].at(c,r)-trB[i].at(c,r)));
+    }
+
+  double tScalar = measure([&](size_t it){
+    for(auto& s:sk)
+      evalScalar(s,float(it%100)/100.f,trS.data());
+    }, iterations);
+  double tBatched = measure([&](size_t it){
+    for(auto& s:sk)
+      evalBatched(s,float(it%100)/100.f,trB.data());
+    }, iterations);
+
+  const double poses = double(skeletons*iterations);
+  std::printf("skeletons: %zu, bones: %zu, iterations: %zu\n", skeletons, bones, iterations);
+  std::printf("scalar : %8.3f ms total, %6.3f us/pose\n", tScalar,  tScalar *1000.0/poses);
+  std::printf("batched: %8.3f ms total, %6.3f us/pose\n", tBatched, tBatched*1000.0/poses);
+  std::printf("speedup: %.2fx, max abs difference: %g\n", tScalar/tBatched, double(maxErr));
+  return 0;
+  }
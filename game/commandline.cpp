@@ -73,6 +73,16 @@ CommandLine::CommandLine(int argc, const char** argv) {
       if(i<argc)
         wrldDef = argv[i];
       }
+    else if(arg=="-record") {
+      ++i;
+      if(i<argc)
+        recordPath = argv[i];
+      }
+    else if(arg=="-replay") {
+      ++i;
+      if(i<argc)
+        replayPath = argv[i];
+      }
     else if(arg=="-window") {
       isWindow = true;
       }
@@ -111,6 +121,33 @@ CommandLine::CommandLine(int argc, const char** argv) {
           }
         }
       }
+    else if(arg=="-headless") {
+      ++i;
+      if(i<argc) {
+        try {
+          headlessMin = uint32_t(std::stoul(std::string(argv[i])));
+          }
+        catch (const std::exception& e) {
+          Log::i("failed to read headless time: \"", std::string(argv[i]), "\"");
+          }
+        }
+      }
+    else if(arg=="-timestep") {
+      ++i;
+      if(i<argc) {
+        try {
+          timestepMs = std::clamp<uint64_t>(std::stoul(std::string(argv[i])), 5, 50);
+          }
+        catch (const std::exception& e) {
+          Log::i("failed to read timestep: \"", std::string(argv[i]), "\"");
+          }
+        }
+      }
+    else if(arg=="-animpack") {
+      ++i;
+      if(i<argc)
+        isAnimPack = (std::string_view(argv[i])!="0" && std::string_view(argv[i])!="false");
+      }
     else if(arg=="-gi") {
       ++i;
       if(i<argc)
@@ -46,6 +46,12 @@ class CommandLine {
     bool                doForceG2NR()      const { return forceG2NR;    }
     bool                aaPreset()         const { return aaPresetId;   }
     std::string_view    defaultSave()      const { return saveDef;    }
+    bool                isAnimPacked()     const { return isAnimPack;   }
+    bool                isHeadless()       const { return headlessMin>0; }
+    uint64_t            headlessTime()     const { return uint64_t(headlessMin)*60*1000; }
+    uint64_t            timestep()         const { return timestepMs;   }
+    std::string_view    recordFile()       const { return recordPath;   }
+    std::string_view    replayFile()       const { return replayPath;   }
 
     std::string         wrldDef;
 
@@ -57,6 +63,7 @@ class CommandLine {
     std::u16string      gscript;
     std::u16string      gcutscene;
     std::string         saveDef;
+    std::string         recordPath, replayPath;
     bool                devmode      = false;
     bool                noMenu       = false;
     bool                isWindow     = false;
@@ -74,6 +81,9 @@ class CommandLine {
     bool                forceG1      = false;
     bool                forceG2      = false;
     bool                forceG2NR    = false;
+    bool                isAnimPack   = false;
     uint32_t            aaPresetId = 0;
+    uint32_t            headlessMin   = 0;
+    uint64_t            timestepMs    = 1000/60;
   };
 
@@ -14,11 +14,13 @@ Mem32::Mem32() {
    *  [0x80000000 .. 0xc0000000] - (1GB) extra space(reserved for opengothic use; pinned memory)
    *  [0xc0000000 .. 0xffffffff] - (1GB) kernel space
    */
-  region.emplace_back(Region(0x1000,0x80000000));
+  Region user(0x1000,0x80000000);
+  region.emplace(user.address,user);
+  addFree(user);
   }
 
 Mem32::~Mem32() {
-  for(auto& rgn:region) {
+  for(auto& [addr,rgn]:region) {
     if(rgn.status==S_Allocated && rgn.real!=nullptr) {
       std::free(rgn.real);
       rgn.real = nullptr;
@@ -28,7 +30,6 @@ Mem32::~Mem32() {
 
 Mem32::ptr32_t Mem32::pin(void* mem, ptr32_t address, uint32_t size, const char* comment) {
   if(auto rgn = implAllocAt(address,size)) {
-    rgn->size    = size;
     rgn->real    = mem;
     rgn->status  = S_Pin;
     rgn->comment = comment;
@@ -39,10 +40,11 @@ Mem32::ptr32_t Mem32::pin(void* mem, ptr32_t address, uint32_t size, const char*
 
 Mem32::ptr32_t Mem32::pin(void* mem, uint32_t size, const char* comment) {
   if(auto rgn = implAlloc(size)) {
-    rgn->size    = size;
-    rgn->real    = mem;
-    rgn->status  = S_Pin;
-    rgn->comment = comment;
+    // NOTE: alignment padding stays with pinned block, but is not addressable
+    rgn->requested = size;
+    rgn->real      = mem;
+    rgn->status    = S_Pin;
+    rgn->comment   = comment;
     return rgn->address;
     }
   return 0;
@@ -52,10 +54,9 @@ Mem32::ptr32_t Mem32::alloc(ptr32_t address, uint32_t size, const char* comment)
   if(auto rgn = implAllocAt(address,size)) {
     rgn->real = std::calloc(size,1);
     if(rgn->real==nullptr) {
-      compactage();
+      release(region.find(rgn->address));
       return 0;
       }
-    rgn->size    = size;
     rgn->status  = S_Allocated;
     rgn->comment = comment;
     return address;
@@ -65,9 +66,9 @@ Mem32::ptr32_t Mem32::alloc(ptr32_t address, uint32_t size, const char* comment)
 
 Mem32::ptr32_t Mem32::alloc(uint32_t size) {
   if(auto rgn = implAlloc(size)) {
-    rgn->real = std::calloc(size,1);
+    rgn->real = std::calloc(rgn->size,1);
     if(rgn->real==nullptr) {
-      compactage();
+      release(region.find(rgn->address));
       return 0;
       }
     rgn->status = S_Allocated;
@@ -79,30 +80,14 @@ Mem32::ptr32_t Mem32::alloc(uint32_t size) {
 void Mem32::free(ptr32_t address) {
   if(address==0)
     return;
-  for(size_t i=0; i<region.size(); ++i) {
-    if(region[i].address!=address)
-      continue;
-    std::free(region[i].real);
-    region[i].real   = nullptr;
-    region[i].status = S_Unused;
-    compactage();
+  auto it = region.find(address);
+  if(it==region.end() || it->second.status==S_Unused) {
+    Log::e("mem_free: heap block wan't allocated by script: ", reinterpret_cast<void*>(uint64_t(address)));
     return;
     }
-  Log::e("mem_free: heap block wan't allocated by script: ", reinterpret_cast<void*>(uint64_t(address)));
-  }
-
-void Mem32::compactage() {
-  for(size_t i=0; i+1<region.size(); ) {
-    auto& a = region[i+0];
-    auto& b = region[i+1];
-    if(a.status==S_Unused && a.status==b.status && a.address+a.size==b.address) {
-      a.size += b.size;
-      b.size = 0;
-      region.erase(region.begin()+ptrdiff_t(i+1));
-      } else {
-      ++i;
-      }
-    }
+  if(it->second.status==S_Allocated)
+    std::free(it->second.real);
+  release(it);
   }
 
 void Mem32::writeInt(ptr32_t address, int32_t v) {
@@ -131,12 +116,12 @@ int32_t Mem32::readInt(ptr32_t address) {
 
 void Mem32::copyBytes(ptr32_t psrc, ptr32_t pdst, uint32_t size) {
   auto src = translate(psrc);
-  auto dst = translate(pdst);
-  if(src==nullptr || src->status==S_Unused) {
+  if(src==nullptr) {
     Log::e("mem_copybytes: address translation failure: ", reinterpret_cast<void*>(uint64_t(psrc)));
     return;
     }
-  if(dst==nullptr || dst->status==S_Unused) {
+  auto dst = translate(pdst);
+  if(dst==nullptr) {
     Log::e("mem_copybytes: address translation failure: ", reinterpret_cast<void*>(uint64_t(pdst)));
     return;
     }
@@ -144,153 +129,215 @@ void Mem32::copyBytes(ptr32_t psrc, ptr32_t pdst, uint32_t size) {
   size_t sOff = psrc - src->address;
   size_t dOff = pdst - dst->address;
   size_t sz   = size;
-  if(src->size<sOff+size) {
+  if(src->limit()<sOff+size) {
     Log::e("mem_copybytes: copy-size exceed source block size: ", size);
-    sz = std::min(src->size-sOff,sz);
+    sz = std::min(src->limit()-sOff,sz);
     }
-  if(dst->size<dOff+size) {
+  if(dst->limit()<dOff+size) {
     Log::e("mem_copybytes: copy-size exceed destination block size: ", size);
-    sz = std::min(dst->size-dOff,sz);
+    sz = std::min(dst->limit()-dOff,sz);
     }
-  std::memcpy(reinterpret_cast<uint8_t*>(dst->real)+sOff,
-              reinterpret_cast<uint8_t*>(src->real)+dOff,
-              sz);
+  std::memmove(reinterpret_cast<uint8_t*>(dst->real)+dOff,
+               reinterpret_cast<uint8_t*>(src->real)+sOff,
+               sz);
   }
 
 Mem32::Region* Mem32::implAlloc(uint32_t size) {
   size = ((size+memAlign-1)/memAlign)*memAlign;
+  if(size==0)
+    size = memAlign;
 
-  for(size_t i=0; i<region.size(); ++i) {
-    if(region[i].status!=S_Unused || region[i].size<size)
-      continue;
-    if(size!=region[i].size) {
-      auto p2 = region[i];
-      p2.address+=size;
-      p2.size   -=size;
-      region.insert(region.begin()+ptrdiff_t(i+1),p2);
-      }
-    region[i].size = size;
-    return &region[i];
-    }
+  auto fr = freeBlocks.lower_bound(std::make_pair(size,ptr32_t(0)));
+  if(fr==freeBlocks.end())
+    return nullptr;
 
-  return nullptr;
+  auto it = region.find(fr->second);
+  eraseFree(it->second);
+  split(it,size);
+  return &it->second;
   }
 
 Mem32::ptr32_t Mem32::realloc(ptr32_t address, uint32_t size) {
   size = ((size+memAlign-1)/memAlign)*memAlign;
+  if(address==0)
+    return alloc(size);
   if(implRealloc(address,size))
     return address;
 
+  auto src = region.find(address);
+  if(src==region.end() || src->second.status!=S_Allocated) {
+    Log::e("realloc: address translation failure: ", reinterpret_cast<void*>(uint64_t(address)));
+    return alloc(size);
+    }
+
   auto next = implAlloc(size);
   if(next==nullptr)
     return 0;
 
-  auto src = translate(address);
-  if(src==nullptr) {
-    if(address!=0)
-      Log::e("realloc: address translation failure: ", reinterpret_cast<void*>(uint64_t(address)));
-    return next->address;
+  const uint32_t prevSize = src->second.size;
+  auto           real     = std::realloc(src->second.real,next->size);
+  if(real==nullptr) {
+    release(region.find(next->address));
+    return 0;
     }
+  if(prevSize<next->size)
+    std::memset(reinterpret_cast<uint8_t*>(real)+prevSize,0,next->size-prevSize);
 
   next->status  = S_Allocated;
-  next->real    = src->real;
-  next->comment = src->comment;
-
-  src->real     = nullptr;
-  src->status   = S_Unused;
+  next->real    = real;
+  next->comment = src->second.comment;
 
   auto ret = next->address;
-  compactage();
+  release(src);
   return ret;
   }
 
 Mem32::Region* Mem32::implAllocAt(ptr32_t address, uint32_t size) {
-  for(size_t i=0; i<region.size(); ++i) {
-    auto& rgn = region[i];
-
-    if(address!=0) {
-      if(!(rgn.address<=address && address+size<=rgn.address+rgn.size))
-        continue;
-      } else {
-      if(rgn.size<size)
-        continue;
-      }
+  if(address==0)
+    return implAlloc(size);
 
-    if(rgn.status!=S_Unused) {
-      Log::e("failed to pin a ",size," bytes of memory: block is in use");
-      return 0;
-      }
+  auto it = region.upper_bound(address);
+  if(it==region.begin()) {
+    Log::e("failed to pin a ",size," bytes of memory: out of address space");
+    return nullptr;
+    }
+  --it;
 
-    if(address==0)
-      address = region[i].address;
-
-    if(region[i].address<address) {
-      uint32_t off = (address-region[i].address);
-      auto p2 = region[i];
-      p2.address+=off;
-      p2.size   -=off;
-      region.insert(region.begin()+ptrdiff_t(i+1),p2);
-      region[i].size = off;
-      ++i;
-      }
-    if(size!=region[i].size) {
-      auto p2 = region[i];
-      p2.address+=size;
-      p2.size   -=size;
-      region.insert(region.begin()+ptrdiff_t(i+1),p2);
-      }
+  auto& rgn = it->second;
+  if(uint64_t(address)+size > uint64_t(rgn.address)+rgn.size) {
+    Log::e("failed to pin a ",size," bytes of memory: block is in use");
+    return nullptr;
+    }
+  if(rgn.status!=S_Unused) {
+    Log::e("failed to pin a ",size," bytes of memory: block is in use");
+    return nullptr;
+    }
 
-    return &region[i];
+  eraseFree(rgn);
+  if(rgn.address<address) {
+    auto head = it;
+    it = split(it,address-rgn.address);
+    eraseFree(it->second);
+    addFree(head->second);
     }
-  return nullptr;
+  split(it,size);
+  return &it->second;
   }
 
 bool Mem32::implRealloc(ptr32_t address, uint32_t nsize) {
   // NOTE: in place only
-  for(size_t i=0; i<region.size(); ++i) {
-    auto& rgn = region[i];
-    if(rgn.address!=address)
-      continue;
-
-    if(nsize==rgn.size)
-      return true;
-
-    if(nsize<rgn.size) {
-      if(auto next = std::realloc(rgn.real, nsize))
-        rgn.real = next;
-      Region frgn(address+nsize, rgn.size-nsize);
-      rgn.size = nsize;
-      region.insert(region.begin() + intptr_t(i + 1), frgn);
-      return true;
-      }
+  auto it = region.find(address);
+  if(it==region.end() || it->second.status!=S_Allocated)
+    return false;
 
-    if(i+1==region.size())
-      return false; // can't expand
-
-    auto& rgn2 = region[i+1];
-    if(rgn2.status==S_Unused && rgn.size + rgn2.size>=nsize) {
-      auto next = std::realloc(rgn.real, nsize);
-      if(next==nullptr)
-        return false;
-      rgn2.address += (nsize-rgn.size);
-      rgn2.size    -= (nsize-rgn.size);
-      rgn.real      = next;
-      rgn.size      = nsize;
-      if(rgn2.size==0)
-        compactage();
-      return true;
-      }
+  auto& rgn = it->second;
+  if(nsize==rgn.size)
+    return true;
+
+  if(nsize<rgn.size) {
+    if(nsize==0)
+      return false;
+    if(auto next = std::realloc(rgn.real, nsize))
+      rgn.real = next;
+    auto tail = split(it,nsize);
+    release(tail);
+    return true;
+    }
 
-    return false;
+  auto it2 = std::next(it);
+  if(it2==region.end())
+    return false; // can't expand
+
+  auto& rgn2 = it2->second;
+  if(rgn2.status==S_Unused && rgn.address+rgn.size==rgn2.address && rgn.size + rgn2.size>=nsize) {
+    auto next = std::realloc(rgn.real, nsize);
+    if(next==nullptr)
+      return false;
+    std::memset(reinterpret_cast<uint8_t*>(next)+rgn.size,0,nsize-rgn.size);
+
+    const uint32_t grow = nsize-rgn.size;
+    eraseFree(rgn2);
+    if(rgn2.size==grow) {
+      region.erase(it2);
+      } else {
+      auto node = region.extract(it2);
+      node.key()            += grow;
+      node.mapped().address += grow;
+      node.mapped().size    -= grow;
+      addFree(node.mapped());
+      region.insert(std::move(node));
+      }
+    rgn.real = next;
+    rgn.size = nsize;
+    return true;
     }
+
   return false;
   }
 
 Mem32::Region* Mem32::translate(ptr32_t address) {
-  // TODO: binary-search
-  for(auto& rgn:region) {
-    if(rgn.address<=address && address<rgn.address+rgn.size && rgn.status!=S_Unused)
-      return &rgn;
+  if(lastHit!=nullptr && lastHit->address<=address && address-lastHit->address<lastHit->limit())
+    return lastHit;
+
+  auto it = region.upper_bound(address);
+  if(it==region.begin())
+    return nullptr;
+  --it;
+
+  auto& rgn = it->second;
+  if(rgn.status==S_Unused || address-rgn.address>=rgn.limit())
+    return nullptr;
+  lastHit = &rgn;
+  return &rgn;
+  }
+
+Mem32::RegionIt Mem32::split(RegionIt it, uint32_t size) {
+  // unused tail goes to free-list; returns tail block
+  auto& rgn = it->second;
+  if(size>=rgn.size)
+    return it;
+
+  Region tail(rgn.address+size, rgn.size-size);
+  rgn.size = size;
+  addFree(tail);
+  return region.emplace_hint(std::next(it),tail.address,tail);
+  }
+
+void Mem32::release(RegionIt it) {
+  auto& rgn = it->second;
+  if(rgn.status==S_Unused)
+    eraseFree(rgn);
+  rgn.real      = nullptr;
+  rgn.comment   = nullptr;
+  rgn.requested = uint32_t(-1);
+  rgn.status    = S_Unused;
+  lastHit       = nullptr;
+
+  auto next = std::next(it);
+  if(next!=region.end() && next->second.status==S_Unused && rgn.address+rgn.size==next->second.address) {
+    eraseFree(next->second);
+    rgn.size += next->second.size;
+    region.erase(next);
     }
-  return nullptr;
+
+  if(it!=region.begin()) {
+    auto  prev = std::prev(it);
+    auto& prgn = prev->second;
+    if(prgn.status==S_Unused && prgn.address+prgn.size==rgn.address) {
+      eraseFree(prgn);
+      prgn.size += rgn.size;
+      region.erase(it);
+      it = prev;
+      }
+    }
+
+  addFree(it->second);
+  }
+
+void Mem32::addFree(const Region& r) {
+  freeBlocks.emplace(r.size,r.address);
+  }
+
+void Mem32::eraseFree(const Region& r) {
+  freeBlocks.erase(std::make_pair(r.size,r.address));
   }
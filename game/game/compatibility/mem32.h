@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <vector>
 #include <memory>
+#include <map>
+#include <set>
+#include <cstdint>
 
 class Mem32 {
   public:
@@ -37,20 +41,35 @@ class Mem32 {
       Region();
       Region(ptr32_t b, uint32_t sz):address(b),size(sz){}
 
+      // addressable part of block; padding of pinned memory is owned, but not addressable
+      uint32_t                            limit() const { return std::min(size,requested); }
+
       //std::function<void(ptr32_t offset)> callback;
-      ptr32_t                             address = 0;
-      uint32_t                            size    = 0;
-      void*                               real    = nullptr;
-      const char*                         comment = nullptr;
-      Status                              status  = S_Unused;
+      ptr32_t                             address   = 0;
+      uint32_t                            size      = 0;
+      uint32_t                            requested = uint32_t(-1); // pinned: size of pinned memory
+      void*                               real      = nullptr;
+      const char*                         comment   = nullptr;
+      Status                              status    = S_Unused;
       };
 
+    using RegionIt = std::map<ptr32_t,Region>::iterator;
+
     Region*  implAlloc(uint32_t size);
     Region*  implAllocAt(ptr32_t address, uint32_t size);
     bool     implRealloc(ptr32_t address, uint32_t size);
     Region*  translate(ptr32_t address);
-    void     compactage();
+    RegionIt split(RegionIt it, uint32_t size);
+    void     release(RegionIt it);
+
+    void     addFree(const Region& r);
+    void     eraseFree(const Region& r);
 
-    std::vector<Region> region;
+    // blocks, ordered by address; adjacent unused blocks are always merged
+    std::map<ptr32_t,Region>              region;
+    // unused blocks, ordered by size - best fit allocation
+    std::set<std::pair<uint32_t,ptr32_t>> freeBlocks;
+    // last translated block: scripts tend to access same object many times in a row
+    Region*                               lastHit = nullptr;
   };
 
@@ -16,6 +16,7 @@
 #include "world/triggers/abstracttrigger.h"
 #include "graphics/visualfx.h"
 #include "utils/fileutil.h"
+#include "utils/profiler.h"
 #include "commandline.h"
 #include "gothic.h"
 
@@ -75,12 +76,13 @@ int GameScript::PerDist::at(PercType perc, int r) const {
 
 
 GameScript::GameScript(GameSession &owner)
-    :owner(owner), vm(createVm(Gothic::inst())) {
+    :owner(owner), vm(createVm(Gothic::inst())), callProfiler(vm) {
   if (vm.global_self() == nullptr || vm.global_other() == nullptr || vm.global_item() == nullptr ||
       vm.global_victim() == nullptr || vm.global_hero() == nullptr)
     throw std::runtime_error("Cannot find script symbol SELF, OTHER, ITEM, VICTIM, or HERO! Cannot proceed!");
 
   vmLang = Gothic::inst().settingsGetI("GAME", "language");
+  randGen.seed(Gothic::inst().randomSeed());
   zenkit::register_all_script_classes(vm);
   vm.register_exception_handler(zenkit::lenient_vm_exception_handler);
   Gothic::inst().setupVmCommonApi(vm);
@@ -92,6 +94,8 @@ GameScript::GameScript(GameSession &owner)
 
 GameScript::~GameScript() {
   Gothic::inst().onSettingsChanged.ubind(this,&GameScript::initSettings);
+  if(callProfiler.hasData())
+    callProfiler.write("scriptprofile.txt");
   }
 
 void GameScript::initCommon() {
@@ -503,6 +507,7 @@ void GameScript::initializeInstanceNpc(const std::shared_ptr<zenkit::INpc>& npc,
     auto* daily_routine = vm.find_symbol_by_index(uint32_t(npc->daily_routine));
 
     if(daily_routine != nullptr) {
+      ScriptProfiler::Call call(callProfiler,daily_routine);
       vm.call_function(daily_routine);
       }
     }
@@ -873,6 +878,7 @@ std::vector<GameScript::DlgChoice> GameScript::dialogChoices(std::shared_ptr<zen
       if(info.condition) {
         auto* conditionSymbol = vm.find_symbol_by_index(uint32_t(info.condition));
         if (conditionSymbol != nullptr) {
+          ScriptProfiler::Call call(callProfiler,conditionSymbol);
           valid = vm.call_function<int>(conditionSymbol) != 0;
           }
         }
@@ -939,7 +945,9 @@ void GameScript::exec(const GameScript::DlgChoice &dlg, Npc& player, Npc& npc) {
         ++i;
       }
     }
-  vm.call_function(vm.find_symbol_by_index(dlg.scriptFn));
+  auto* fn = vm.find_symbol_by_index(dlg.scriptFn);
+  ScriptProfiler::Call call(callProfiler,fn);
+  vm.call_function(fn);
   }
 
 void GameScript::printCannotUseError(Npc& npc, int32_t atr, int32_t nValue) {
@@ -1023,10 +1031,12 @@ void GameScript::invokeState(const std::shared_ptr<zenkit::INpc>& hnpc, const st
 
   ScopeVar self (*vm.global_self(),  hnpc);
   ScopeVar other(*vm.global_other(), oth);
+  ScriptProfiler::Call call(callProfiler,id);
   vm.call_function<void>(id);
   }
 
 int GameScript::invokeState(Npc* npc, Npc* oth, Npc* vic, ScriptFn fn) {
+  Profiler::Zone zone("GameScript::invokeState");
   if(!fn.isValid())
     return 0;
   if(oth==nullptr){
@@ -1048,6 +1058,7 @@ int GameScript::invokeState(Npc* npc, Npc* oth, Npc* vic, ScriptFn fn) {
 
   auto* sym = vm.find_symbol_by_index(uint32_t(fn.ptr));
   int   ret = 0;
+  ScriptProfiler::Call call(callProfiler,sym);
   if(sym!=nullptr && sym->rtype() == zenkit::DaedalusDataType::INT) {
     ret = vm.call_function<int>(sym);
     }
@@ -1075,6 +1086,7 @@ void GameScript::invokeItem(Npc *npc, ScriptFn fn) {
     return;
 
   ScopeVar self(*vm.global_self(), npc->handlePtr());
+  ScriptProfiler::Call call(callProfiler,functionSymbol);
   vm.call_function<void>(functionSymbol);
   }
 
@@ -1111,6 +1123,7 @@ void GameScript::invokeSpell(Npc &npc, Npc* target, Item &it) {
   int32_t  splLevel = 0;
   ScopeVar self (*vm.global_self(),  npc.handlePtr());
   ScopeVar other(*vm.global_other(), target != nullptr ? target->handlePtr() : nullptr);
+  ScriptProfiler::Call call(callProfiler,fn);
   try {
     if(fn->count()==1) {
       // this is a leveled spell
@@ -1131,6 +1144,7 @@ int GameScript::invokeCond(Npc& npc, std::string_view func) {
     return 1;
     }
   ScopeVar self(*vm.global_self(), npc.handlePtr());
+  ScriptProfiler::Call call(callProfiler,fn);
   return vm.call_function<int>(fn);
   }
 
@@ -1296,6 +1310,7 @@ void GameScript::useInteractive(const std::shared_ptr<zenkit::INpc>& hnpc, std::
     return;
 
   ScopeVar self(*vm.global_self(),hnpc);
+  ScriptProfiler::Call call(callProfiler,fn);
   try {
     vm.call_function<void>(fn);
     }
@@ -17,6 +17,7 @@
 #include "game/constants.h"
 #include "game/aistate.h"
 #include "game/questlog.h"
+#include "game/scriptprofiler.h"
 
 class GameSession;
 class World;
@@ -76,6 +77,7 @@ class GameScript final {
     void         loadPerc(Serialize& fin);
 
     inline auto& getVm() { return vm; }
+    auto&        profiler() { return callProfiler; }
     auto         questLog() const -> const QuestLog&;
 
     const World& world() const;
@@ -195,8 +197,13 @@ class GameScript final {
 
     template <class F>
     void bindExternal(const std::string& name, F function) {
+      auto*          sym = vm.find_symbol_by_name(name);
+      const uint32_t id  = sym!=nullptr ? sym->index() : uint32_t(-1);
       vm.register_external(name, std::function<typename DetermineSignature<F>::signature> (
-                                   [this, function](auto ... v) { return (this->*function)(v...); }));
+                                   [this, function, id](auto ... v) {
+                                     ScriptProfiler::Call call(callProfiler,id);
+                                     return (this->*function)(v...);
+                                     }));
       }
 
     void  initCommon();
@@ -444,6 +451,7 @@ class GameScript final {
 
     GameSession&                                                owner;
     zenkit::DaedalusVm                                          vm;
+    ScriptProfiler                                              callProfiler;
     int32_t                                                     vmLang = -1;
     std::mt19937                                                randGen;
 
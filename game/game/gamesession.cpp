@@ -2,7 +2,6 @@
 #include "savegameheader.h"
 
 #include <Tempest/Log>
-#include <Tempest/MemReader>
 #include <Tempest/MemWriter>
 #include <cctype>
 
@@ -33,8 +32,7 @@ void GameSession::HeroStorage::save(Npc& npc) {
 void GameSession::HeroStorage::putToWorld(World& owner, std::string_view wayPoint) const {
   if(storage.size()==0)
     return;
-  Tempest::MemReader rd{storage};
-  Serialize          sr{rd};
+  Serialize sr{storage.data(),storage.size()};
   sr.setEntry("hero");
 
   if(auto pl = owner.player()) {
@@ -70,6 +68,7 @@ GameSession::GameSession(std::string file) {
   cam.reset(new Camera());
 
   Gothic::inst().setLoadingProgress(0);
+  Resources::beginCacheEpoch();
   setupSettings();
   setTime(gtime(8,0));
 
@@ -107,6 +106,7 @@ GameSession::GameSession(std::string file) {
     initScripts(true);
   wrld->triggerOnStart(true);
   cam->reset(wrld->player());
+  Resources::trimCaches();
   Gothic::inst().setLoadingProgress(96);
   ticks = 1;
   // wrld->setDayTime(8,0);
@@ -114,6 +114,7 @@ GameSession::GameSession(std::string file) {
 
 GameSession::GameSession(Serialize &fin) {
   Gothic::inst().setLoadingProgress(0);
+  Resources::beginCacheEpoch();
   setupSettings();
 
   SaveGameHeader hdr;
@@ -163,6 +164,7 @@ GameSession::GameSession(Serialize &fin) {
 
   fin.setEntry("game/camera");
   cam->load(fin,wrld->player());
+  Resources::trimCaches();
   Gothic::inst().setLoadingProgress(96);
   }
 
@@ -372,6 +374,8 @@ auto GameSession::implChangeWorld(std::unique_ptr<GameSession>&& game,
   if(auto hero = wrld->player())
     hdata.save(*hero);
   clearWorld();
+  // assets, not requested by the next world, are candidates for eviction
+  Resources::beginCacheEpoch();
 
   vm->resetVarPointers();
 
@@ -389,8 +393,8 @@ auto GameSession::implChangeWorld(std::unique_ptr<GameSession>&& game,
   setWorld(std::move(ret));
 
   if(!wss.isEmpty()) {
-    Tempest::MemReader rd {wss.storage.data(),wss.storage.size()};
-    Serialize          fin{rd};
+    // visited world is kept packed in memory, until player enters it
+    Serialize fin{wss.storage.data(),wss.storage.size()};
     wrld->load(fin);
     }
 
@@ -412,6 +416,7 @@ auto GameSession::implChangeWorld(std::unique_ptr<GameSession>&& game,
       }
 
   cam->reset(wrld->player());
+  Resources::trimCaches();
   Log::i("Done loading world[",world,"]");
   return std::move(game);
   }
@@ -12,25 +12,25 @@
 using namespace Tempest;
 
 const Item& Inventory::Iterator::operator*() const {
-  return *owner->items[at];
+  return *owner->sortedView[at];
   }
 
 const Item* Inventory::Iterator::operator ->() const {
-  return owner->items[at].get();
+  return owner->sortedView[at];
   }
 
 bool Inventory::Iterator::isEquipped() const {
-  auto& cur = *owner->items[at];
+  auto& cur = *owner->sortedView[at];
   return subId==0 && cur.isEquipped();
   }
 
 uint8_t Inventory::Iterator::slot() const {
-  auto& cur = *owner->items[at];
+  auto& cur = *owner->sortedView[at];
   return subId==0 ? cur.slot() : Item::NSLOT;
   }
 
 size_t Inventory::Iterator::count() const {
-  auto& cur = *owner->items[at];
+  auto& cur = *owner->sortedView[at];
   if(!cur.isMulti()) {
     if(cur.isEquipped() && subId==0)
       return cur.equipCount();
@@ -42,7 +42,7 @@ size_t Inventory::Iterator::count() const {
   }
 
 Inventory::Iterator& Inventory::Iterator::operator++() {
-  auto& it  = owner->items;
+  auto& it  = owner->sortedView;
   auto& cur = *it[at];
   if(!cur.isMulti()) {
     if(cur.isEquipped() && cur.count()>1 && subId==0) {
@@ -57,7 +57,7 @@ Inventory::Iterator& Inventory::Iterator::operator++() {
   }
 
 bool Inventory::Iterator::isValid() const {
-  return at<owner->items.size();
+  return at<owner->sortedView.size();
   }
 
 Inventory::Iterator::Iterator(Inventory::IteratorType t, const Inventory* owner)
@@ -67,7 +67,7 @@ Inventory::Iterator::Iterator(Inventory::IteratorType t, const Inventory* owner)
   }
 
 void Inventory::Iterator::skipHidden() {
-  auto& it = owner->items;
+  auto& it = owner->sortedView;
   if(type==T_Trade) {
     while(at<it.size() && (it[at]->isEquipped() || it[at]->isGold()))
       ++at;
@@ -96,6 +96,8 @@ void Inventory::implLoad(Npc* owner, World& world, Serialize &s) {
   s.read(sz);
   for(size_t i=0;i<sz;++i)
     items.emplace_back(std::make_unique<Item>(world,s,Item::T_Inventory));
+  sorted = false;
+  rebuildIndex();
 
   s.read(sz);
   mdlSlots.resize(sz);
@@ -192,16 +194,14 @@ Inventory::Iterator Inventory::iterator(IteratorType t) const {
   }
 
 int32_t Inventory::priceOf(size_t cls) const {
-  for(auto& i:items)
-    if(i->clsId()==cls)
-      return i->cost();
+  if(auto it = findByClass(cls))
+    return it->cost();
   return 0;
   }
 
 int32_t Inventory::sellPriceOf(size_t cls) const {
-  for(auto& i:items)
-    if(i->clsId()==cls)
-      return i->sellCost();
+  if(auto it = findByClass(cls))
+    return it->sellCost();
   return 0;
   }
 
@@ -213,9 +213,8 @@ size_t Inventory::goldCount() const {
   }
 
 size_t Inventory::itemCount(const size_t cls) const {
-  for(auto& i:items)
-    if(i->clsId()==cls)
-      return i->count();
+  if(auto it = findByClass(cls))
+    return it->count();
   return 0;
   }
 
@@ -229,7 +228,7 @@ Item* Inventory::addItem(std::unique_ptr<Item> &&p) {
   Item* it=findByClass(cls);
   if(it==nullptr) {
     p->clearView();
-    items.emplace_back(std::move(p));
+    pushItem(std::move(p));
     return items.back().get();
     } else {
     it->setCount(it->count()+p->count());
@@ -257,7 +256,7 @@ Item* Inventory::addItem(size_t itemSymbol, size_t count, World &owner) {
     try {
       std::unique_ptr<Item> ptr{new Item(owner,itemSymbol,Item::T_Inventory)};
       ptr->setCount(count);
-      items.emplace_back(std::move(ptr));
+      pushItem(std::move(ptr));
       return items.back().get();
       }
     catch(const std::runtime_error& call) {
@@ -301,39 +300,42 @@ void Inventory::delItem(Item *it, size_t count, Npc& owner) {
       }
   sorted=false;
 
+  auto id = byClass.find(it->clsId());
+  if(id!=byClass.end() && items[id->second].get()==it) {
+    takeItem(id->second);
+    return;
+    }
   for(size_t i=0;i<items.size();++i)
-    if(items[i]->clsId()==it->clsId()){
-      items.erase(items.begin()+int(i));
+    if(items[i].get()==it) {
+      takeItem(i);
       break;
       }
   }
 
 void Inventory::transfer(Inventory &to, Inventory &from, Npc* fromNpc, size_t itemSymbol, size_t count, World &wrld) {
-  for(size_t i=0;i<from.items.size();++i){
-    auto& it = *from.items[i];
-    if(it.clsId()!=itemSymbol)
-      continue;
+  auto id = from.byClass.find(itemSymbol);
+  if(id==from.byClass.end())
+    return;
 
-    from.sorted = false;
-    to.sorted   = false;
+  auto& it = *from.items[id->second];
+  from.sorted = false;
+  to.sorted   = false;
 
-    if(count>it.count())
-      count=it.count();
+  if(count>it.count())
+    count=it.count();
 
-    if(it.count()==count) {
-      if(it.isEquipped()) {
-        if(fromNpc==nullptr){
-          Log::e("Inventory: invalid transfer call");
-          return; // error
-          }
-        from.unequip(&it,*fromNpc);
+  if(it.count()==count) {
+    if(it.isEquipped()) {
+      if(fromNpc==nullptr){
+        Log::e("Inventory: invalid transfer call");
+        return; // error
         }
-      to.addItem(std::move(from.items[i]));
-      from.items.erase(from.items.begin()+int(i));
-      } else {
-      it.setCount(it.count()-count);
-      to.addItem(itemSymbol,count,wrld);
+      from.unequip(&it,*fromNpc);
       }
+    to.addItem(from.takeItem(id->second));
+    } else {
+    it.setCount(it.count()-count);
+    to.addItem(itemSymbol,count,wrld);
     }
   }
 
@@ -563,7 +565,9 @@ void Inventory::clear(GameScript&, Npc&, bool includeMissionItm) {
     if(i->isEquipped() || (i->isMission() && !includeMissionItm)){
       used.emplace_back(std::move(i));
       }
-  items = std::move(used); // Gothic don't clear items, which are in use
+  items  = std::move(used); // Gothic don't clear items, which are in use
+  sorted = false;
+  rebuildIndex();
   }
 
 void Inventory::clear(GameScript& vm, Interactive& owner, bool includeMissionItm) {
@@ -572,7 +576,9 @@ void Inventory::clear(GameScript& vm, Interactive& owner, bool includeMissionItm
     if(i->isMission() && !includeMissionItm){
       used.emplace_back(std::move(i));
       }
-  items = std::move(used); // Gothic don't clear items, which are in use
+  items  = std::move(used); // Gothic don't clear items, which are in use
+  sorted = false;
+  rebuildIndex();
   }
 
 bool Inventory::hasSpell(int32_t splId) const {
@@ -600,9 +606,8 @@ bool Inventory::hasRangedWeaponWithAmmo() const {
   for(auto& i:items) {
     uint32_t cls = uint32_t(i->handle().munition);
     if(cls>0 && cls!=munition) {
-      for(auto& it:items)
-        if(it->clsId()==cls)
-          return true;
+      if(findByClass(cls)!=nullptr)
+        return true;
       munition = cls;
       }
     }
@@ -932,10 +937,46 @@ void Inventory::equipBestArmour(Npc &owner) {
   }
 
 Item *Inventory::findByClass(size_t cls) {
-  for(auto& i:items)
-    if(i->clsId()==cls)
-      return i.get();
-  return nullptr;
+  auto it = byClass.find(cls);
+  if(it==byClass.end())
+    return nullptr;
+  return items[it->second].get();
+  }
+
+const Item* Inventory::findByClass(size_t cls) const {
+  auto it = byClass.find(cls);
+  if(it==byClass.end())
+    return nullptr;
+  return items[it->second].get();
+  }
+
+std::unique_ptr<Item> Inventory::takeItem(size_t id) {
+  // swap with last, to keep removal O(1)
+  auto ret = std::move(items[id]);
+  if(id+1!=items.size()) {
+    items[id] = std::move(items.back());
+    byClass[items[id]->clsId()] = id;
+    }
+  items.pop_back();
+
+  auto cls = byClass.find(ret->clsId());
+  if(cls!=byClass.end() && cls->second==id)
+    byClass.erase(cls);
+  sorted = false;
+  return ret;
+  }
+
+void Inventory::pushItem(std::unique_ptr<Item>&& it) {
+  byClass.emplace(it->clsId(),items.size());
+  items.emplace_back(std::move(it));
+  sorted = false;
+  }
+
+void Inventory::rebuildIndex() {
+  byClass.clear();
+  byClass.reserve(items.size());
+  for(size_t i=0; i<items.size(); ++i)
+    byClass.emplace(items[i]->clsId(),i); // NOTE: first one wins, for duplicates in old saves
   }
 
 Item* Inventory::bestItem(Npc &owner, ItmFlags f) {
@@ -994,7 +1035,10 @@ void Inventory::sortItems() const {
   if(sorted)
     return;
   sorted = true;
-  std::sort(items.begin(),items.end(),[](std::unique_ptr<Item>& l, std::unique_ptr<Item>& r){
+  sortedView.resize(items.size());
+  for(size_t i=0; i<items.size(); ++i)
+    sortedView[i] = items[i].get();
+  std::sort(sortedView.begin(),sortedView.end(),[](const Item* l, const Item* r){
     return less(*l,*r);
     });
   }
@@ -1050,6 +1094,9 @@ uint8_t Inventory::slotId(Item *&slt) const {
 uint32_t Inventory::indexOf(const Item *it) const {
   if(it==nullptr)
     return uint32_t(-1);
+  auto id = byClass.find(it->clsId());
+  if(id!=byClass.end() && items[id->second].get()==it)
+    return uint32_t(id->second);
   for(size_t i=0;i<items.size();++i)
     if(items[i].get()==it)
       return uint32_t(i);
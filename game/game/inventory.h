@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include <string_view>
 #include <string>
 
@@ -135,7 +136,11 @@ class Inventory final {
     void   applyArmour (Item& it, Npc &owner, int32_t sgn);
 
     Item*  findByClass(size_t cls);
+    const Item* findByClass(size_t cls) const;
     void   delItem    (Item* it, size_t count, Npc& owner);
+    auto   takeItem   (size_t id) -> std::unique_ptr<Item>;
+    void   pushItem   (std::unique_ptr<Item>&& it);
+    void   rebuildIndex();
     void   invalidateCond(Item*& slot,  Npc &owner);
 
     Item*  bestItem       (Npc &owner, ItmFlags f);
@@ -150,8 +155,11 @@ class Inventory final {
     static int  orderId(const Item& l);
     uint8_t     slotId (Item*& slt) const;
 
-    mutable std::vector<std::unique_ptr<Item>> items;
-    mutable bool                               sorted=false;
+    // items are owned by vector in arbitrary order; Item* stays valid until item is removed from inventory
+    std::vector<std::unique_ptr<Item>> items;
+    std::unordered_map<size_t,size_t>  byClass;    // class-id -> position in items
+    mutable std::vector<Item*>         sortedView; // ui order, rebuilt on demand
+    mutable bool                       sorted=false;
 
     uint32_t                           indexOf(const Item* it) const;
     Item*                              readPtr(Serialize& fin);
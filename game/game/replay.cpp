@@ -0,0 +1,386 @@
+#include "replay.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "utils/mappedfile.h"
+#include "world/objects/npc.h"
+#include "commandline.h"
+#include "gothic.h"
+
+using namespace Tempest;
+
+static const char     magic[4]      = {'O','G','R','P'};
+static const uint32_t version       = 1;
+// state checksum is stored for every n-th frame
+static const size_t   checksumEvery = 64;
+
+namespace {
+struct Writer final {
+  std::vector<uint8_t> data;
+
+  template<class T>
+  void write(const T& v) {
+    const size_t at = data.size();
+    data.resize(at+sizeof(T));
+    std::memcpy(&data[at],&v,sizeof(T));
+    }
+  void write(std::string_view s) {
+    write(uint32_t(s.size()));
+    data.insert(data.end(),s.begin(),s.end());
+    }
+  };
+
+struct Reader final {
+  const uint8_t* at  = nullptr;
+  const uint8_t* end = nullptr;
+
+  template<class T>
+  bool read(T& v) {
+    if(size_t(end-at)<sizeof(T))
+      return false;
+    std::memcpy(&v,at,sizeof(T));
+    at += sizeof(T);
+    return true;
+    }
+  bool read(std::string& s) {
+    uint32_t sz = 0;
+    if(!read(sz) || size_t(end-at)<sz)
+      return false;
+    s.assign(reinterpret_cast<const char*>(at),sz);
+    at += sz;
+    return true;
+    }
+  };
+}
+
+static uint64_t elapsedUs(Replay::clock::time_point a, Replay::clock::time_point b) {
+  return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(b-a).count());
+  }
+
+Replay::Replay() {
+  auto& cmd = CommandLine::inst();
+  if(!cmd.replayFile().empty()) {
+    path = cmd.replayFile();
+    if(load(path)) {
+      mode = M_Play;
+      Log::i("replay: \"",path,"\", ",frames.size()," frames");
+      } else {
+      Log::e("replay: unable to read \"",path,"\"");
+      }
+    }
+  else if(!cmd.recordFile().empty()) {
+    path = cmd.recordFile();
+    mode = M_Record;
+    }
+  }
+
+Replay::~Replay() {
+  if(mode==M_Record && started)
+    save();
+  if(mode==M_Play)
+    finish();
+  }
+
+void Replay::begin(std::string_view s, bool isSave) {
+  if(mode==M_Play) {
+    if(started) {
+      // trace covers one session only
+      Log::e("replay: new session started - playback stopped");
+      finish();
+      return;
+      }
+    started = true;
+    Gothic::inst().setRandomSeed(seed);
+    return;
+    }
+
+  if(mode!=M_Record)
+    return;
+  if(started)
+    save();
+  started    = true;
+  slot       = s;
+  slotIsSave = isSave;
+  seed       = std::random_device()();
+  frames.clear();
+  events.clear();
+  pending    = 0;
+  preCount   = 0;
+  tickMarked = false;
+  Gothic::inst().setRandomSeed(seed);
+  }
+
+void Replay::push(const Event& e) {
+  if(mode!=M_Record || !started)
+    return;
+  events.push_back(e);
+  }
+
+void Replay::markTick() {
+  if(mode!=M_Record || !started)
+    return;
+  preCount   = events.size()-pending;
+  tickMarked = true;
+  }
+
+const Replay::Frame* Replay::nextFrame() {
+  if(mode!=M_Play)
+    return nullptr;
+  if(current>=frames.size()) {
+    finish();
+    return nullptr;
+    }
+  return &frames[current++];
+  }
+
+void Replay::endFrame(uint64_t dt) {
+  if(mode==M_Record && started) {
+    if(!tickMarked)
+      preCount = events.size()-pending;
+    Frame f;
+    f.dt    = dt;
+    f.begin = uint32_t(pending);
+    f.pre   = uint16_t(preCount);
+    f.post  = uint16_t(events.size()-pending-preCount);
+    if(frames.size()%checksumEvery==0)
+      f.checksum = checksum();
+    frames.push_back(f);
+    pending    = events.size();
+    preCount   = 0;
+    tickMarked = false;
+    return;
+    }
+
+  if(mode==M_Play && current>0) {
+    const size_t id = current-1;
+    inFlight = true;
+    if(id%checksumEvery==0 && desync==size_t(-1) && frames[id].checksum!=checksum()) {
+      // live ui input (dialogs, inventory, menus) is not traced - stop here, timings past this point are meaningless
+      desync = id;
+      Log::e("replay: game state diverged from recording at frame ",id);
+      finish();
+      }
+    }
+  }
+
+void Replay::timing(clock::time_point t0, clock::time_point t1, clock::time_point t2) {
+  if(mode!=M_Play || !inFlight)
+    return;
+  inFlight = false;
+
+  Timing t;
+  t.frame = lastFrame==clock::time_point() ? 0 : elapsedUs(lastFrame,t0);
+  t.tick  = elapsedUs(t0,t1);
+  t.anim  = elapsedUs(t1,t2);
+  if(auto w = Gothic::inst().world()) {
+    auto wt   = w->takeTickTimings();
+    t.objects = wt.objects;
+    t.physics = wt.physics;
+    t.view    = wt.view;
+    t.sound   = wt.sound;
+    t.effects = wt.effects;
+    }
+  timings.resize(current);
+  timings[current-1] = t;
+  lastFrame = t0;
+  }
+
+uint32_t Replay::checksum() {
+  // FNV-1a over state, that diverges quickly, if input or random sequence differ
+  uint32_t h   = 2166136261u;
+  auto     mix = [&h](const void* data, size_t size) {
+    auto b = reinterpret_cast<const uint8_t*>(data);
+    for(size_t i=0; i<size; ++i) {
+      h ^= b[i];
+      h *= 16777619u;
+      }
+    };
+
+  auto* w = Gothic::inst().world();
+  if(w==nullptr)
+    return h;
+  const uint64_t tick = w->tickCount();
+  mix(&tick,sizeof(tick));
+  if(auto pl = w->player()) {
+    const auto    pos = pl->position();
+    const int32_t hp  = pl->attribute(ATR_HITPOINTS);
+    mix(&pos.x,sizeof(pos.x));
+    mix(&pos.y,sizeof(pos.y));
+    mix(&pos.z,sizeof(pos.z));
+    mix(&hp,   sizeof(hp));
+    }
+  return h;
+  }
+
+bool Replay::load(std::string_view file) {
+  try {
+    MappedFile fin(file);
+    Reader     r{fin.data(), fin.data()+fin.size()};
+
+    char     mg[4] = {};
+    uint32_t ver   = 0, frameCount = 0, eventCount = 0;
+    uint8_t  isSave = 0;
+    if(!r.read(mg) || std::memcmp(mg,magic,sizeof(magic))!=0)
+      return false;
+    if(!r.read(ver) || ver!=version)
+      return false;
+    if(!r.read(seed) || !r.read(isSave) || !r.read(slot) || !r.read(frameCount) || !r.read(eventCount))
+      return false;
+    slotIsSave = isSave!=0;
+
+    frames.resize(frameCount);
+    uint32_t begin = 0;
+    for(size_t i=0; i<frames.size(); ++i) {
+      auto&   f  = frames[i];
+      uint8_t dt = 0;
+      if(!r.read(dt) || !r.read(f.pre) || !r.read(f.post))
+        return false;
+      if(i%checksumEvery==0 && !r.read(f.checksum))
+        return false;
+      f.dt    = dt;
+      f.begin = begin;
+      begin  += uint32_t(f.pre+f.post);
+      }
+    if(begin!=eventCount)
+      return false;
+
+    events.resize(eventCount);
+    for(auto& e:events) {
+      uint8_t type = 0;
+      if(!r.read(type))
+        return false;
+      e.type = EventType(type);
+      switch(e.type) {
+        case E_KeyPressed:
+          if(!r.read(e.action) || !r.read(e.mapping) || !r.read(e.key))
+            return false;
+          break;
+        case E_KeyReleased:
+          if(!r.read(e.action) || !r.read(e.mapping))
+            return false;
+          break;
+        case E_ClearInput:
+          break;
+        case E_Rotate:
+          if(!r.read(e.x) || !r.read(e.y))
+            return false;
+          break;
+        case E_Camera:
+          if(!r.read(e.x) || !r.read(e.y))
+            return false;
+          break;
+        default:
+          return false;
+        }
+      }
+    return true;
+    }
+  catch(...) {
+    return false;
+    }
+  }
+
+void Replay::save() const {
+  Writer w;
+  w.write(magic);
+  w.write(version);
+  w.write(seed);
+  w.write(uint8_t(slotIsSave ? 1 : 0));
+  w.write(std::string_view(slot));
+  w.write(uint32_t(frames.size()));
+  w.write(uint32_t(events.size()));
+  for(size_t i=0; i<frames.size(); ++i) {
+    auto& f = frames[i];
+    // main loop clamps dt to 50 ms
+    w.write(uint8_t(std::min<uint64_t>(f.dt,255)));
+    w.write(f.pre);
+    w.write(f.post);
+    if(i%checksumEvery==0)
+      w.write(f.checksum);
+    }
+  for(auto& e:events) {
+    w.write(uint8_t(e.type));
+    switch(e.type) {
+      case E_KeyPressed:
+        w.write(e.action);
+        w.write(e.mapping);
+        w.write(e.key);
+        break;
+      case E_KeyReleased:
+        w.write(e.action);
+        w.write(e.mapping);
+        break;
+      case E_ClearInput:
+        break;
+      case E_Rotate:
+      case E_Camera:
+        w.write(e.x);
+        w.write(e.y);
+        break;
+      }
+    }
+
+  try {
+    WFile f(path);
+    f.write(w.data.data(),w.data.size());
+    f.flush();
+    Log::i("record: \"",path,"\", ",frames.size()," frames");
+    }
+  catch(...) {
+    Log::e("record: unable to write \"",path,"\"");
+    }
+  }
+
+void Replay::finish() {
+  if(mode!=M_Play)
+    return;
+  mode = M_Off;
+  writeCsv();
+  if(desync==size_t(-1))
+    Log::i("replay: done, ",current," frames");
+  else
+    Log::e("replay: stopped, ",current," frames; state diverged at frame ",desync,", timing marked invalid");
+  }
+
+void Replay::writeCsv() const {
+  const std::string csv = path + ".csv";
+  std::string       out;
+  char              buf[256] = {};
+  if(desync!=size_t(-1)) {
+    std::snprintf(buf,sizeof(buf),"# invalid: game state diverged from recording at frame %llu\n",
+                  static_cast<unsigned long long>(desync));
+    out += buf;
+    }
+  out += "frame,dt,frame_us,tick_us,anim_us,objects_us,physics_us,view_us,sound_us,effects_us\n";
+  for(size_t i=0; i<timings.size(); ++i) {
+    auto& t = timings[i];
+    std::snprintf(buf,sizeof(buf),"%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                  static_cast<unsigned long long>(i),
+                  static_cast<unsigned long long>(frames[i].dt),
+                  static_cast<unsigned long long>(t.frame),
+                  static_cast<unsigned long long>(t.tick),
+                  static_cast<unsigned long long>(t.anim),
+                  static_cast<unsigned long long>(t.objects),
+                  static_cast<unsigned long long>(t.physics),
+                  static_cast<unsigned long long>(t.view),
+                  static_cast<unsigned long long>(t.sound),
+                  static_cast<unsigned long long>(t.effects));
+    out += buf;
+    }
+
+  try {
+    WFile f(csv);
+    f.write(out.data(),out.size());
+    f.flush();
+    Log::i("replay: timing written to \"",csv,"\"");
+    }
+  catch(...) {
+    Log::e("replay: unable to write \"",csv,"\"");
+    }
+  }
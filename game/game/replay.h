@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// session trace for performance regression runs: startup slot, random seed, frame dt and player-control input.
+// Playback feeds the same dt and input to the game, verifies state checksum and writes per-frame timing as csv.
+// Ui input (dialogs, inventory, menus) is not traced: playback stops at first checksum mismatch and marks csv invalid
+class Replay final {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    enum EventType : uint8_t {
+      E_KeyPressed,
+      E_KeyReleased,
+      E_ClearInput,
+      E_Rotate,
+      E_Camera,
+      };
+
+    struct Event final {
+      EventType type    = E_ClearInput;
+      uint8_t   action  = 0;
+      uint8_t   mapping = 0;
+      uint16_t  key     = 0;
+      float     x       = 0;
+      float     y       = 0;
+      };
+
+    struct Frame final {
+      uint64_t dt       = 0;
+      uint32_t begin    = 0; // first event
+      uint16_t pre      = 0; // events, applied before game tick
+      uint16_t post     = 0; // events, applied after game tick
+      uint32_t checksum = 0;
+      };
+
+    Replay();
+    ~Replay();
+
+    bool         isRecording() const { return mode==M_Record; }
+    bool         isPlaying()   const { return mode==M_Play;   }
+
+    // playback: session, the trace starts with
+    auto         startSlot()   const -> std::string_view { return slot; }
+    bool         startIsSave() const { return slotIsSave; }
+
+    // new session is about to load: reseeds random generators; recording starts over
+    void         begin(std::string_view slot, bool isSave);
+
+    // recording
+    void         push(const Event& e);
+    void         markTick();
+
+    // playback: nullptr, once trace is over
+    auto         nextFrame() -> const Frame*;
+    const Event& event(size_t id) const { return events[id]; }
+
+    // end of game tick: recording stores frame, playback verifies it
+    void         endFrame(uint64_t dt);
+    void         timing(clock::time_point t0, clock::time_point t1, clock::time_point t2);
+
+  private:
+    enum Mode : uint8_t {
+      M_Off,
+      M_Record,
+      M_Play,
+      };
+
+    struct Timing final {
+      uint64_t frame   = 0;
+      uint64_t tick    = 0;
+      uint64_t anim    = 0;
+      uint64_t objects = 0;
+      uint64_t physics = 0;
+      uint64_t view    = 0;
+      uint64_t sound   = 0;
+      uint64_t effects = 0;
+      };
+
+    static uint32_t checksum();
+
+    bool         load(std::string_view file);
+    void         save() const;
+    void         finish();
+    void         writeCsv() const;
+
+    Mode                mode       = M_Off;
+    std::string         path;
+    std::string         slot;
+    bool                slotIsSave = false;
+    bool                started    = false;
+    uint32_t            seed       = 0;
+
+    std::vector<Frame>  frames;
+    std::vector<Event>  events;
+    size_t              pending    = 0; // recording: first event of current frame
+    size_t              preCount   = 0;
+    bool                tickMarked = false;
+
+    size_t              current    = 0; // playback: frames[current-1] is in flight
+    size_t              desync     = size_t(-1);
+    bool                inFlight   = false; // playback: frame is ticked, but not timed yet
+    std::vector<Timing> timings;
+    clock::time_point   lastFrame;
+  };
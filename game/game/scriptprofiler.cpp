@@ -0,0 +1,204 @@
+#include "scriptprofiler.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace Tempest;
+
+ScriptProfiler::ScriptProfiler(zenkit::DaedalusVm& vm)
+  :vm(vm) {
+  }
+
+ScriptProfiler::Call::Call(ScriptProfiler& owner, const zenkit::DaedalusSymbol* sym)
+  :owner(owner.enabled && sym!=nullptr ? &owner : nullptr) {
+  if(this->owner!=nullptr)
+    this->owner->enter(sym->index());
+  }
+
+uint64_t ScriptProfiler::now() {
+  using namespace std::chrono;
+  return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+  }
+
+void ScriptProfiler::setEnabled(bool e) {
+  if(e && !enabled) {
+    stat.clear();
+    stack.clear();
+    samples.clear();
+    }
+  enabled = e;
+  Log::i("script profiler: ", e ? "enabled" : "disabled");
+  }
+
+void ScriptProfiler::setSampleInterval(uint64_t ms) {
+  sampleInterval = ms*1000000;
+  if(sampleInterval==0 || !functions.empty())
+    return;
+
+  for(auto& s:vm.symbols()) {
+    if(s.is_external() || s.is_member())
+      continue;
+    const auto t = s.type();
+    if(t!=zenkit::DaedalusDataType::FUNCTION && t!=zenkit::DaedalusDataType::PROTOTYPE && t!=zenkit::DaedalusDataType::INSTANCE)
+      continue;
+    // function-typed and instance variables have no code
+    if(s.address()==0 && !s.is_const())
+      continue;
+    functions.push_back({s.address(), s.index()});
+    }
+  std::sort(functions.begin(),functions.end(),[](const FnRange& l, const FnRange& r){
+    return l.address<r.address;
+    });
+  }
+
+bool ScriptProfiler::hasData() const {
+  for(auto& i:stat)
+    if(i.calls>0)
+      return true;
+  return false;
+  }
+
+void ScriptProfiler::enter(uint32_t sym) {
+  if(sym>=stat.size())
+    stat.resize(std::max<size_t>(sym+1u, vm.symbols().size()));
+  auto& st = stat[sym];
+  st.calls++;
+  st.depth++;
+
+  stack.push_back({sym,0,0});
+  if(sampleInterval>0) {
+    const uint64_t time = now();
+    if(time-lastSample>=sampleInterval)
+      sample(time);
+    }
+  stack.back().begin = now();
+  }
+
+void ScriptProfiler::leave() {
+  if(stack.empty())
+    return;
+  const Frame    f  = stack.back();
+  const uint64_t dt = now()-f.begin;
+  stack.pop_back();
+
+  auto& st = stat[f.sym];
+  st.depth--;
+  if(st.depth==0)
+    st.inclusive += dt;
+  st.exclusive += dt>f.child ? dt-f.child : 0;
+  if(!stack.empty())
+    stack.back().child += dt;
+  }
+
+void ScriptProfiler::sample(uint64_t time) {
+  lastSample = time;
+
+  std::string key;
+  for(size_t i=0; i<stack.size(); ++i) {
+    if(i>0)
+      key += ';';
+    if(i+1==stack.size() && i>0) {
+      // external, called from script: vm is paused inside of the caller
+      auto* top = vm.find_symbol_by_index(stack[i].sym);
+      auto* fn  = top!=nullptr && top->is_external() ? functionAt(vm.pc()) : nullptr;
+      if(fn!=nullptr && fn->index()!=stack[i-1].sym) {
+        key += fn->name();
+        key += ';';
+        }
+      }
+    key += symbolName(stack[i].sym);
+    }
+  samples[key]++;
+  }
+
+const zenkit::DaedalusSymbol* ScriptProfiler::functionAt(uint32_t pc) const {
+  auto it = std::upper_bound(functions.begin(),functions.end(),pc,[](uint32_t pc, const FnRange& r){
+    return pc<r.address;
+    });
+  if(it==functions.begin())
+    return nullptr;
+  --it;
+  return vm.find_symbol_by_index(it->sym);
+  }
+
+std::vector<uint32_t> ScriptProfiler::sortedStat() const {
+  std::vector<uint32_t> ret;
+  for(size_t i=0; i<stat.size(); ++i)
+    if(stat[i].calls>0)
+      ret.push_back(uint32_t(i));
+  std::sort(ret.begin(),ret.end(),[this](uint32_t l, uint32_t r){
+    return stat[l].exclusive>stat[r].exclusive;
+    });
+  return ret;
+  }
+
+std::string_view ScriptProfiler::symbolName(uint32_t sym) const {
+  auto* s = vm.find_symbol_by_index(sym);
+  if(s==nullptr)
+    return "?";
+  return s->name();
+  }
+
+std::vector<std::string> ScriptProfiler::report(size_t count) const {
+  std::vector<std::string> ret;
+  char                     buf[256] = {};
+  for(auto i:sortedStat()) {
+    if(ret.size()>=count)
+      break;
+    auto& st   = stat[i];
+    auto  name = symbolName(i);
+    std::snprintf(buf,sizeof(buf),"%.*s: calls = %llu, incl = %.2f ms, excl = %.2f ms",
+                  int(name.size()),name.data(),static_cast<unsigned long long>(st.calls),
+                  double(st.inclusive)/1e6,double(st.exclusive)/1e6);
+    ret.emplace_back(buf);
+    }
+  return ret;
+  }
+
+bool ScriptProfiler::write(std::string_view file) const {
+  std::string out;
+  char        buf[512] = {};
+  std::snprintf(buf,sizeof(buf),"%-48s %12s %14s %14s %10s\n","function","calls","inclusive ms","exclusive ms","external");
+  out += buf;
+  for(auto i:sortedStat()) {
+    auto& st   = stat[i];
+    auto* sym  = vm.find_symbol_by_index(i);
+    auto  name = symbolName(i);
+    std::snprintf(buf,sizeof(buf),"%-48.*s %12llu %14.3f %14.3f %10s\n",
+                  int(name.size()),name.data(),static_cast<unsigned long long>(st.calls),
+                  double(st.inclusive)/1e6,double(st.exclusive)/1e6,
+                  sym!=nullptr && sym->is_external() ? "yes" : "no");
+    out += buf;
+    }
+
+  if(!samples.empty()) {
+    // collapsed stacks: input of flamegraph tools
+    std::vector<std::pair<std::string_view,uint64_t>> smp(samples.begin(),samples.end());
+    std::sort(smp.begin(),smp.end(),[](const auto& l, const auto& r){
+      return l.second>r.second;
+      });
+    out += "\nsamples:\n";
+    for(auto& i:smp) {
+      out += i.first;
+      out += ' ';
+      out += std::to_string(i.second);
+      out += '\n';
+      }
+    }
+
+  try {
+    WFile f{std::string(file)};
+    f.write(out.data(),out.size());
+    f.flush();
+    }
+  catch(...) {
+    Log::e("script profiler: unable to write \"",file,"\"");
+    return false;
+    }
+  Log::i("script profiler: report written to \"",file,"\"");
+  return true;
+  }
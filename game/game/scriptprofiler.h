@@ -0,0 +1,82 @@
+#pragma once
+
+#include <zenkit/DaedalusVm.hh>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// call count, inclusive and exclusive time of script functions, called by engine, and of externals.
+// Script-to-script calls are invisible to engine: sampled call stacks show, which script function calls into externals
+class ScriptProfiler final {
+  public:
+    explicit ScriptProfiler(zenkit::DaedalusVm& vm);
+
+    class Call final {
+      public:
+        Call(ScriptProfiler& owner, const zenkit::DaedalusSymbol* sym);
+        Call(ScriptProfiler& owner, uint32_t sym):owner(owner.enabled && sym!=uint32_t(-1) ? &owner : nullptr) {
+          if(this->owner!=nullptr)
+            this->owner->enter(sym);
+          }
+        Call(const Call&) = delete;
+        ~Call() {
+          if(owner!=nullptr)
+            owner->leave();
+          }
+        Call& operator = (const Call&) = delete;
+
+      private:
+        ScriptProfiler* owner = nullptr;
+      };
+
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool e);
+    // stack is sampled on first call after interval; 0 - no sampling
+    void setSampleInterval(uint64_t ms);
+
+    bool hasData() const;
+    // top functions by exclusive time
+    auto report(size_t count) const -> std::vector<std::string>;
+    bool write(std::string_view file) const;
+
+  private:
+    struct Stat final {
+      uint64_t calls     = 0;
+      uint64_t inclusive = 0; // nanoseconds
+      uint64_t exclusive = 0;
+      uint32_t depth     = 0; // recursion: inclusive time is counted at outermost call
+      };
+
+    struct Frame final {
+      uint32_t sym   = 0;
+      uint64_t begin = 0;
+      uint64_t child = 0;
+      };
+
+    struct FnRange final {
+      uint32_t address = 0;
+      uint32_t sym     = 0;
+      };
+
+    static uint64_t now();
+
+    void enter(uint32_t sym);
+    void leave();
+    void sample(uint64_t time);
+    auto functionAt(uint32_t pc) const -> const zenkit::DaedalusSymbol*;
+    auto sortedStat() const -> std::vector<uint32_t>;
+    auto symbolName(uint32_t sym) const -> std::string_view;
+
+    zenkit::DaedalusVm&                       vm;
+    bool                                      enabled        = false;
+    std::vector<Stat>                         stat;
+    std::vector<Frame>                        stack;
+
+    uint64_t                                  sampleInterval = 0;
+    uint64_t                                  lastSample     = 0;
+    std::vector<FnRange>                      functions;
+    std::unordered_map<std::string, uint64_t> samples; // collapsed call stack -> count
+  };
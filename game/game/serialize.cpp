@@ -6,6 +6,7 @@
 #include "world/world.h"
 #include "world/fplock.h"
 #include "world/waypoint.h"
+#include "utils/workers.h"
 
 #include <Tempest/MemReader>
 #include <Tempest/MemWriter>
@@ -50,19 +51,15 @@ size_t Serialize::readFunc(void* pOpaque, uint64_t file_ofs, void* pBuf, size_t
   return ret;
   }
 
-Serialize::Serialize() {}
+Serialize::Serialize() : writer(true) {
+  entryName.reserve(256);
+  }
 
 //static uint64_t time0 = 0;
 
-Serialize::Serialize(Tempest::ODevice& fout) : fout(&fout) {
+Serialize::Serialize(Tempest::ODevice& fout) : writer(true), fout(&fout) {
   //time0 = Tempest::Application::tickCount();
-  entryBuf .reserve(1*1024*1024);
   entryName.reserve(256);
-
-  impl.m_pWrite           = Serialize::writeFunc;
-  impl.m_pIO_opaque       = this;
-  impl.m_zip_type         = MZ_ZIP_TYPE_USER;
-  mz_zip_writer_init_v2(&impl, 0, 0);
   }
 
 Serialize::Serialize(Tempest::IDevice& fin) : fin(&fin) {
@@ -75,15 +72,127 @@ Serialize::Serialize(Tempest::IDevice& fin) : fin(&fin) {
   mz_zip_reader_init(&impl, fin.size(), 0);
   }
 
+Serialize::Serialize(const void* data, size_t size)
+  : memArchive(reinterpret_cast<const uint8_t*>(data)), memSize(size) {
+  entryName.reserve(256);
+  mz_zip_reader_init_mem(&impl, data, size, 0);
+  }
+
 Serialize::~Serialize() {
-  closeEntry();
-  if(fout!=nullptr) {
-    mz_zip_writer_finalize_archive(&impl);
-    mz_zip_writer_end(&impl);
+  if(writer && fout!=nullptr) {
+    try {
+      writeArchive(*fout,true);
+      }
+    catch(...) {
+      Tempest::Log::e("unable to write game archive");
+      }
     //Tempest::Log::d("save time = ", Tempest::Application::tickCount()-time0);
     }
   }
 
+Serialize Serialize::fork() const {
+  Serialize ret;
+  ret.curVer = curVer;
+  ret.wldVer = wldVer;
+  ret.ctx    = ctx;
+  return ret;
+  }
+
+void Serialize::merge(Serialize&& part) {
+  closeEntry();
+  part.closeEntry();
+  if(entries.empty()) {
+    entries = std::move(part.entries);
+    } else {
+    entries.reserve(entries.size()+part.entries.size());
+    for(auto& i:part.entries)
+      entries.emplace_back(std::move(i));
+    }
+  part.entries.clear();
+  }
+
+void Serialize::packEntry(Entry& e) {
+  if(e.stored || e.data.size()<=256)
+    return;
+
+  static const mz_uint flags  = tdefl_create_comp_flags_from_zip_params(MZ_BEST_SPEED, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+  size_t               outLen = 0;
+  void*                out    = tdefl_compress_mem_to_heap(e.data.data(), e.data.size(), &outLen, int(flags));
+  if(out==nullptr)
+    throw std::runtime_error("unable to compress entry in game archive");
+
+  std::vector<uint8_t> packed(outLen);
+  std::memcpy(packed.data(), out, outLen);
+  mz_free(out);
+
+  e.crc     = mz_uint32(mz_crc32(MZ_CRC32_INIT, e.data.data(), e.data.size()));
+  e.rawSize = e.data.size();
+  e.data    = std::move(packed);
+  e.packed  = true;
+  }
+
+void Serialize::writeArchive(Tempest::ODevice& dev, bool parallel) {
+  // archive is written once: state is reset on any exit, so destructor never writes through stale device
+  struct Finish {
+    Serialize& self;
+    bool       init = false;
+    ~Finish() {
+      if(init)
+        mz_zip_writer_end(&self.impl);
+      self.entries.clear();
+      self.fout   = nullptr;
+      self.writer = false;
+      }
+    } finish{*this};
+
+  closeEntry();
+
+  // compression is independent per entry
+  if(parallel) {
+    Workers::parallelTasks(entries,[](Entry& e){ packEntry(e); });
+    } else {
+    for(auto& e:entries)
+      packEntry(e);
+    }
+
+  fout      = &dev;
+  curOffset = 0;
+  impl                    = {};
+  impl.m_pWrite           = Serialize::writeFunc;
+  impl.m_pIO_opaque       = this;
+  impl.m_zip_type         = MZ_ZIP_TYPE_USER;
+  if(!mz_zip_writer_init_v2(&impl, 0, 0))
+    throw std::runtime_error("unable to create game archive");
+  finish.init = true;
+
+  // forked parts record own directories: same directory may come more than once
+  std::unordered_set<std::string> dirs;
+  for(auto& e:entries) {
+    if(e.dir) {
+      if(!dirs.insert(e.name).second)
+        continue;
+      mz_bool status = mz_zip_writer_add_mem(&impl, e.name.c_str(), NULL, 0, MZ_NO_COMPRESSION);
+      if(!status)
+        throw std::runtime_error("unable to allocate entry in game archive");
+      continue;
+      }
+
+    mz_bool status = MZ_FALSE;
+    if(e.packed) {
+      status = mz_zip_writer_add_mem_ex(&impl, e.name.c_str(), e.data.data(), e.data.size(), nullptr, 0,
+                                        MZ_BEST_SPEED | MZ_ZIP_FLAG_COMPRESSED_DATA, e.rawSize, e.crc);
+      } else {
+      status = mz_zip_writer_add_mem(&impl, e.name.c_str(), e.data.data(), e.data.size(), MZ_NO_COMPRESSION);
+      }
+    if(!status)
+      throw std::runtime_error("unable to write entry in game archive");
+    e.data = std::vector<uint8_t>();
+    }
+
+  if(!mz_zip_writer_finalize_archive(&impl))
+    throw std::runtime_error("unable to finalize game archive");
+  }
+
 std::string_view Serialize::worldName() const {
   if(ctx!=nullptr)
     return ctx->name();
@@ -91,60 +200,152 @@ std::string_view Serialize::worldName() const {
   }
 
 void Serialize::closeEntry() {
-  if(fout==nullptr)
+  if(!writer)
     return;
-  if(entryBuf.empty())
+  if(entryBuf.empty()) {
+    entryStored = false;
     return;
+    }
+
+  // compression is deferred until writeArchive
+  Entry e;
+  e.name   = entryName;
+  e.data   = std::move(entryBuf);
+  e.stored = entryStored;
+  entries.emplace_back(std::move(e));
 
-  mz_uint level  = entryBuf.size()>256 ? MZ_BEST_SPEED : MZ_NO_COMPRESSION;
-  mz_bool status = mz_zip_writer_add_mem(&impl, entryName.c_str(), entryBuf.data(), entryBuf.size(), level);
-  entryBuf .clear();
+  entryBuf    = std::vector<uint8_t>();
+  entryStored = false;
   entryName.clear();
-  if(!status)
-    throw std::runtime_error("unable to write entry in game archive");
   }
 
 bool Serialize::implSetEntry(std::string_view fname) {
-  size_t prefix = 0;
-  if(fout!=nullptr) {
-    while(prefix<fname.size() && prefix<entryName.size()) {
-      if(entryName[prefix]!=fname[prefix])
-        break;
-      ++prefix;
-      }
-    }
   closeEntry();
   entryName = fname;
-  if(fout!=nullptr) {
-    for(size_t i=prefix; i<entryName.size(); ++i) {
+  if(writer) {
+    // directories are recorded right away, even if entry itself stays empty
+    for(size_t i=0; i<entryName.size(); ++i) {
       if(entryName[i]=='/' && i+1<entryName.size()) {
-        const char prev = entryName[i+1];
-        entryName[i+1] = '\0';
-        const auto it = outFileList.insert(entryName.c_str());
-        if(it.second) {
-          mz_bool status = mz_zip_writer_add_mem(&impl, entryName.c_str(), NULL, 0, MZ_NO_COMPRESSION);
-          if(!status)
-            throw std::runtime_error("unable to allocate entry in game archive");
+        std::string dir = entryName.substr(0,i+1);
+        if(outFileList.insert(dir).second) {
+          Entry e;
+          e.name = std::move(dir);
+          e.dir  = true;
+          entries.emplace_back(std::move(e));
           }
-        entryName[i+1] = prev;
         }
       }
     return true;
     }
-  if(fin!=nullptr) {
-    mz_uint32 id = mz_uint32(-1);
-    if(mz_zip_reader_locate_file_v2(&impl, entryName.c_str(), nullptr, 0, &id)) {
-      mz_zip_archive_file_stat stat = {};
-      mz_zip_reader_file_stat(&impl,id,&stat);
-      entryBuf.resize(size_t(stat.m_uncomp_size));
-      mz_zip_reader_extract_file_to_mem(&impl,entryName.c_str(),entryBuf.data(),entryBuf.size(),0);
-      } else {
-      entryBuf.clear();
+
+  entryData  = nullptr;
+  entrySize  = 0;
+  readOffset = 0;
+
+  mz_uint32 id = mz_uint32(-1);
+  if(!mz_zip_reader_locate_file_v2(&impl, entryName.c_str(), nullptr, 0, &id))
+    return false;
+
+  if(auto it = prefetched.find(id); it!=prefetched.end()) {
+    entryBuf = std::move(it->second);
+    prefetched.erase(it);
+    entryData = entryBuf.data();
+    entrySize = entryBuf.size();
+    return entrySize>0;
+    }
+
+  mz_zip_archive_file_stat stat = {};
+  if(!mz_zip_reader_file_stat(&impl,id,&stat))
+    return false;
+
+  if(auto raw = rawEntry(stat)) {
+    if(stat.m_method==0) {
+      // zero-copy: read directly from mapped file
+      entryData = raw;
+      entrySize = size_t(stat.m_uncomp_size);
+      return entrySize>0;
+      }
+    if(unpackEntry(raw,stat,entryBuf)) {
+      entryData = entryBuf.data();
+      entrySize = entryBuf.size();
+      return entrySize>0;
       }
-    readOffset = 0;
-    return !entryBuf.empty();
     }
-  return false;
+
+  entryBuf.resize(size_t(stat.m_uncomp_size));
+  if(!mz_zip_reader_extract_to_mem(&impl,id,entryBuf.data(),entryBuf.size(),0))
+    entryBuf.clear();
+  entryData = entryBuf.data();
+  entrySize = entryBuf.size();
+  return entrySize>0;
+  }
+
+const uint8_t* Serialize::rawEntry(const mz_zip_archive_file_stat& stat) const {
+  if(memArchive==nullptr || (stat.m_bit_flag & 0x1)!=0)
+    return nullptr;
+
+  const uint64_t lhOffset = stat.m_local_header_ofs;
+  if(lhOffset+30>memSize)
+    return nullptr;
+
+  const uint8_t* lh = memArchive+lhOffset;
+  auto read16 = [](const uint8_t* p) { return uint32_t(p[0]) | uint32_t(p[1])<<8; };
+  if((read16(lh) | read16(lh+2)<<16)!=0x04034b50)
+    return nullptr;
+
+  const uint64_t at = lhOffset + 30 + read16(lh+26) + read16(lh+28);
+  if(at+stat.m_comp_size>memSize)
+    return nullptr;
+  if(stat.m_method==0 && stat.m_comp_size!=stat.m_uncomp_size)
+    return nullptr;
+  return memArchive+at;
+  }
+
+bool Serialize::unpackEntry(const uint8_t* raw, const mz_zip_archive_file_stat& stat, std::vector<uint8_t>& out) {
+  if(stat.m_method!=MZ_DEFLATED)
+    return false;
+  // tinfl is stateless: safe to call from multiple threads at once
+  out.resize(size_t(stat.m_uncomp_size));
+  size_t sz = tinfl_decompress_mem_to_mem(out.data(), out.size(), raw, size_t(stat.m_comp_size), 0);
+  if(sz!=out.size())
+    return false;
+  return mz_crc32(MZ_CRC32_INIT, out.data(), out.size())==stat.m_crc32;
+  }
+
+void Serialize::implPrefetch(std::string_view dir) {
+  if(writer || memArchive==nullptr)
+    return;
+
+  struct Job {
+    mz_uint32                id = 0;
+    mz_zip_archive_file_stat stat = {};
+    const uint8_t*           raw = nullptr;
+    std::vector<uint8_t>     data;
+    bool                     ok = false;
+    };
+  std::vector<Job> jobs;
+
+  for(mz_uint i = 0; i<mz_zip_reader_get_num_files(&impl); i++) {
+    Job j;
+    if(!mz_zip_reader_file_stat(&impl, i, &j.stat))
+      continue;
+    if(j.stat.m_method!=MZ_DEFLATED || j.stat.m_is_directory)
+      continue;
+    if(std::strncmp(j.stat.m_filename, dir.data(), dir.size())!=0 || prefetched.find(i)!=prefetched.end())
+      continue;
+    j.id  = i;
+    j.raw = rawEntry(j.stat);
+    if(j.raw!=nullptr)
+      jobs.emplace_back(std::move(j));
+    }
+
+  Workers::parallelTasks(jobs,[](Job& j){
+    j.ok = unpackEntry(j.raw,j.stat,j.data);
+    });
+
+  for(auto& j:jobs)
+    if(j.ok)
+      prefetched[j.id] = std::move(j.data);
   }
 
 uint32_t Serialize::implDirectorySize(std::string_view e) {
@@ -173,9 +374,9 @@ void Serialize::writeBytes(const void* buf, size_t sz) {
   }
 
 void Serialize::readBytes(void* buf, size_t sz) {
-  if(fin==nullptr || readOffset+sz>entryBuf.size())
+  if(writer || readOffset+sz>entrySize)
     throw std::runtime_error("unable to read save-game file");
-  std::memcpy(buf,&entryBuf[size_t(readOffset)],sz);
+  std::memcpy(buf,entryData+size_t(readOffset),sz);
   readOffset+=sz;
   }
 
@@ -281,7 +482,7 @@ void Serialize::implWrite(const Tempest::Pixmap& p) {
   }
 
 void Serialize::implRead(Tempest::Pixmap& p) {
-  Tempest::MemReader r{&entryBuf[size_t(readOffset)],size_t(entryBuf.size()-readOffset)};
+  Tempest::MemReader r{entryData+size_t(readOffset),size_t(entrySize-readOffset)};
   p = Tempest::Pixmap(r);
   readOffset += r.cursorPosition();
   }
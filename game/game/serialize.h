@@ -8,6 +8,7 @@
 
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 #include <cstdint>
 #include <type_traits>
 #include <ctime>
@@ -35,11 +36,19 @@ class Serialize {
     enum Version : uint16_t {
       Current = 49
       };
+    // deferred writer: entries are kept in memory, until writeArchive
+    Serialize();
     Serialize(Tempest::ODevice& fout);
     Serialize(Tempest::IDevice&  fin);
+    // reader over archive in memory (mapped file); stored entries are read in place
+    Serialize(const void* data, size_t size);
     Serialize(Serialize&&)=default;
     ~Serialize();
 
+    Serialize fork() const;
+    void      merge(Serialize&& part);
+    void      writeArchive(Tempest::ODevice& fout, bool parallel = false);
+
     uint16_t version()              const { return wldVer; }
     void     setVersion(uint16_t v)       { wldVer = v;    }
     uint16_t globalVersion()        const { return curVer; }
@@ -51,6 +60,22 @@ class Serialize {
       return implSetEntry(s);
       }
 
+    // entry, that is written to archive without compression (already compressed data)
+    template<class ... Args>
+    bool setStoredEntry(const Args& ... args) {
+      string_frm s(args...);
+      const bool ret = implSetEntry(s);
+      entryStored = true;
+      return ret;
+      }
+
+    // decompress all entries within directory in parallel, ahead of setEntry
+    template<class ... Args>
+    void prefetch(const Args& ... args) {
+      string_frm s(args...);
+      implPrefetch(s);
+      }
+
     template<class ... Args>
     uint32_t directorySize(const Args& ... args) {
       string_frm s(args...);
@@ -77,7 +102,15 @@ class Serialize {
     void readNpc(zenkit::DaedalusVm& vm, std::shared_ptr<zenkit::INpc>& npc);
 
   private:
-    Serialize();
+    struct Entry {
+      std::string          name;
+      std::vector<uint8_t> data;
+      bool                 dir     = false;
+      bool                 stored  = false;
+      bool                 packed  = false;
+      uint32_t             crc     = 0;
+      uint64_t             rawSize = 0;
+      };
 
     // trivial types
     void implWrite(bool      i) { implWrite(uint8_t(i ? 1 : 0)); }
@@ -266,11 +299,15 @@ class Serialize {
     void implRead (Interactive*& mobsi);
 
     static size_t writeFunc(void *pOpaque, uint64_t file_ofs, const void *pBuf, size_t n);
+    static void   packEntry(Entry& e);
     static size_t readFunc (void *pOpaque, uint64_t file_ofs, void *pBuf, size_t n);
+    static bool   unpackEntry(const uint8_t* raw, const mz_zip_archive_file_stat& stat, std::vector<uint8_t>& out);
+    const uint8_t* rawEntry(const mz_zip_archive_file_stat& stat) const;
 
     void   closeEntry();
     bool   implSetEntry(std::string_view e);
     uint32_t implDirectorySize(std::string_view e);
+    void   implPrefetch(std::string_view dir);
 
     uint16_t                 curVer = Version::Current;
     uint16_t                 wldVer = Version::Current;
@@ -282,9 +319,18 @@ class Serialize {
     mz_zip_archive           impl      = {};
     std::string              entryName;
     std::vector<uint8_t>     entryBuf;
+    // current entry for reading: either entryBuf or view into memArchive
+    const uint8_t*           entryData = nullptr;
+    size_t                   entrySize = 0;
+    bool                     entryStored = false;
+    bool                     writer      = false;
+    std::vector<Entry>       entries;
     uint64_t                 curOffset = 0;
     uint64_t                 readOffset = 0;
     Tempest::ODevice*        fout      = nullptr;
     Tempest::IDevice*        fin       = nullptr;
+    const uint8_t*           memArchive = nullptr;
+    size_t                   memSize    = 0;
+    std::unordered_map<mz_uint32,std::vector<uint8_t>> prefetched;
   };
 
@@ -15,7 +15,8 @@ WorldStateStorage::WorldStateStorage(World &w)
   }
 
 void WorldStateStorage::save(Serialize &fout) const {
-  fout.setEntry("worlds/",name,".zip");
+  // storage is a zip-archive already - no need to compress it again
+  fout.setStoredEntry("worlds/",name,".zip");
   fout.write(storage);
   }
 
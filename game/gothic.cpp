@@ -4,6 +4,7 @@
 #include <Tempest/TextCodec>
 
 #include <cstring>
+#include <cstdlib>
 #include <cctype>
 
 #include <zenkit/addon/daedalus.hh>
@@ -16,6 +17,7 @@
 #include "game/definitions/particlesdefinitions.h"
 
 #include "world/objects/npc.h"
+#include "graphics/pfx/pfxbucket.h"
 #include "graphics/shaders.h"
 
 #include "utils/fileutil.h"
@@ -222,6 +224,7 @@ Gothic::Gothic() {
   }
 
 Gothic::~Gothic() {
+  waitSave();
   instance = nullptr;
   }
 
@@ -484,6 +487,7 @@ void Gothic::startLoad(std::string_view banner,
 void Gothic::implStartLoadSave(std::string_view banner,
                                bool load,
                                const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f) {
+  waitSave();
   loadTex = banner.empty() ? &saveTex : Resources::loadTexture(banner);
   loadProgress.store(0);
 
@@ -548,6 +552,24 @@ void Gothic::cancelLoading() {
     }
   }
 
+void Gothic::commitSave(std::function<void()> f) {
+  waitSave();
+  saverTh = std::thread([f]() noexcept {
+    Workers::setThreadName("Save thread");
+    try {
+      f();
+      }
+    catch(const std::exception& e) {
+      Tempest::Log::e("save error: ", e.what());
+      }
+    });
+  }
+
+void Gothic::waitSave() {
+  if(saverTh.joinable())
+    saverTh.join();
+  }
+
 void Gothic::tick(uint64_t dt) {
   if(pendingChapter){
     if(aiIsDlgFinished()) {
@@ -929,6 +951,13 @@ float Gothic::inttofloat(int i) {
   return static_cast<float>(i);
   }
 
+void Gothic::setRandomSeed(uint32_t s) {
+  seed = s;
+  randGen.seed(s);
+  PfxBucket::seed(s);
+  std::srand(s);
+  }
+
 int Gothic::hlp_random(int max) {
   auto mod = uint32_t(std::max(1, max));
   return static_cast<int32_t>(randGen() % mod);
@@ -116,6 +116,10 @@ class Gothic final {
 
     static auto  options() -> const Options&;
 
+    // seed of all game-logic random generators; applied to sessions, created afterwards
+    uint32_t     randomSeed() const { return seed; }
+    void         setRandomSeed(uint32_t s);
+
     bool         isGodMode() const { return godMode; }
     void         setGodMode(bool g) { godMode = g; }
 
@@ -135,6 +139,8 @@ class Gothic final {
     void         startLoad(std::string_view banner, const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f);
     void         startSave(Tempest::Texture2d&& tex, const std::function<std::unique_ptr<GameSession>(std::unique_ptr<GameSession>&&)> f);
     void         cancelLoading();
+    void         commitSave(std::function<void()> f);
+    void         waitSave();
 
     void         tick(uint64_t dt);
 
@@ -195,6 +201,7 @@ class Gothic final {
     VersionInfo                             vinfo;
     Options                                 opts;
     std::mt19937                            randGen;
+    uint32_t                                seed = std::mt19937::default_seed;
     uint16_t                                pauseSum=0;
     bool                                    isMarvin       = false;
     bool                                    godMode        = false;
@@ -214,6 +221,7 @@ class Gothic final {
     Tempest::Texture2d                      saveTex;
     std::atomic_int                         loadProgress{0};
     std::thread                             loaderTh;
+    std::thread                             saverTh;
     std::atomic<LoadState>                  loadingFlag{LoadState::Idle};
 
     std::unique_ptr<GameSession>            game, pendingGame;
@@ -2,8 +2,10 @@
 
 #include <Tempest/Log>
 #include <cctype>
+#include <unordered_set>
 
 #include "utils/string_frm.h"
+#include "commandline.h"
 #include "world/objects/npc.h"
 #include "world/world.h"
 #include "resources.h"
@@ -17,6 +19,15 @@ static void setupTime(std::vector<uint64_t>& t0,const std::vector<int32_t>& inp,
     }
   }
 
+// "T_POTION_S0_2_STAND" -> "POTION"
+static std::string_view schemeOf(std::string_view name) {
+  const size_t b = name.find('_');
+  if(b==std::string_view::npos)
+    return "";
+  const size_t e = name.find('_',b+1);
+  return name.substr(b+1, std::min(e,name.size())-b-1).substr(0,63);
+  }
+
 static uint64_t frameClamp(int32_t frame,uint32_t first,uint32_t numFrames,uint32_t last) {
   if(frame<int(first))
     return 0;
@@ -76,29 +87,32 @@ Animation::Animation(zenkit::ModelScript& p, std::string_view name, const bool i
   }
 
 const Animation::Sequence* Animation::sequence(std::string_view name) const {
-  if(sqHot!=nullptr && sqHot->name==name)
-    return sqHot;
-  auto it = std::lower_bound(sequences.begin(),sequences.end(),name,[](const Sequence& s,std::string_view n){
-    return s.name<n;
-    });
+  // never interned - no animation can have this name
+  return sequence(Symbol::find(name));
+  }
 
-  if(it!=sequences.end() && it->name==name) {
-    sqHot = &(*it);
-    return &(*it);
-    }
-  return nullptr;
+const Animation::Sequence* Animation::sequence(Symbol name) const {
+  if(name.isEmpty())
+    return nullptr;
+  auto it = byName.find(name);
+  return it!=byName.end() ? it->second : nullptr;
   }
 
 const Animation::Sequence *Animation::sequenceAsc(std::string_view name) const {
-  for(auto& i:sequences)
-    if(i.askName==name)
-      return &i;
-  return nullptr;
+  auto id = Symbol::find(name);
+  if(id.isEmpty())
+    return nullptr;
+  auto it = byAsc.find(id);
+  return it!=byAsc.end() ? it->second : nullptr;
   }
 
 void Animation::debug() const {
   for(auto& i:sequences)
     Log::d(i.name);
+  auto r = memoryReport();
+  Log::d("animation memory: ",r.total/1024,"kb, samples: ",r.samples/1024,"kb of ",r.rawSamples/1024,"kb raw, ",
+         "packed sequences: ",r.packed,"/",r.sequences,", keys: ",r.keys.keys,"/",r.keys.rawKeys,
+         ", const tracks: ",r.keys.constTracks,"/",r.keys.tracks);
   }
 
 std::string_view Animation::defaultMesh() const {
@@ -107,6 +121,41 @@ std::string_view Animation::defaultMesh() const {
   return "";
   }
 
+size_t Animation::memoryUsage() const {
+  return memoryReport().total;
+  }
+
+Animation::MemoryReport Animation::memoryReport() const {
+  MemoryReport ret;
+  ret.total = sizeof(*this) + sequences.size()*sizeof(Sequence);
+  std::unordered_set<const AnimData*> visited;
+  for(auto& sq:sequences) {
+    // aliases share data with original sequence
+    if(sq.data==nullptr || !visited.insert(sq.data.get()).second)
+      continue;
+    auto& d = *sq.data;
+    const size_t smp = d.samples.size()*sizeof(d.samples[0]) + d.packed.memoryUsage();
+    ret.sequences++;
+    ret.samples    += smp;
+    ret.total      += smp + d.nodeIndex.size()*sizeof(d.nodeIndex[0]) + d.tr.size()*sizeof(d.tr[0]);
+    if(d.packed.isEmpty()) {
+      ret.rawSamples   += d.samples.size()*sizeof(d.samples[0]);
+      ret.keys.rawKeys += d.samples.size()*2;
+      ret.keys.keys    += d.samples.size()*2;
+      ret.keys.tracks  += d.nodeIndex.size()*2;
+      continue;
+      }
+    const auto st = d.packed.stats();
+    ret.packed++;
+    ret.rawSamples       += size_t(d.packed.frameCount())*d.packed.nodeCount()*sizeof(zenkit::AnimationSample);
+    ret.keys.tracks      += st.tracks;
+    ret.keys.constTracks += st.constTracks;
+    ret.keys.keys        += st.keys;
+    ret.keys.rawKeys     += st.rawKeys;
+    }
+  return ret;
+  }
+
 Animation::Sequence& Animation::loadMAN(const zenkit::MdsAnimation& hdr, std::string_view name) {
   sequences.emplace_back(hdr,name);
   auto& ret = sequences.back();
@@ -154,6 +203,16 @@ void Animation::setupIndex() {
     return a.name<b.name;
     });
 
+  byName.reserve(sequences.size());
+  byAsc .reserve(sequences.size());
+  for(auto& sq:sequences) {
+    sq.id    = Symbol(sq.name);
+    sq.ascId = Symbol(sq.askName);
+    byName.emplace(sq.id,&sq);
+    if(!sq.ascId.isEmpty())
+      byAsc.emplace(sq.ascId,&sq); // first one wins, same as linear search did
+    }
+
   for(auto& s:sequences) {
     if(s.comb.size()==0)
       continue;
@@ -180,8 +239,10 @@ void Animation::setupIndex() {
     }
 
   for(auto& i:sequences) {
-    i.nextPtr = sequence(i.next);
+    i.nextId  = Symbol(i.next);
+    i.nextPtr = sequence(i.nextId);
     i.owner   = this;
+    i.scheme  = Symbol(schemeOf(i.name));
     }
   // for(auto& i:sequences)
   //   Log::i(i.name);
@@ -218,6 +279,8 @@ Animation::Sequence::Sequence(const zenkit::MdsAnimation& hdr, std::string_view
   data->samples = p.samples;
 
   setupMoveTr();
+  if(CommandLine::inst().isAnimPacked())
+    data->pack();
   }
 
 bool Animation::Sequence::isFinished(uint64_t now, uint64_t sTime, uint16_t comboLen) const {
@@ -521,22 +584,6 @@ Tempest::Vec3 Animation::Sequence::translateXZ(uint64_t at) const {
   return p;
   }
 
-void Animation::Sequence::schemeName(char scheme[64]) const {
-  scheme[0] = '\0';
-  for(size_t i=0, r=0; i<name.size(); ++i) {
-    if(name[i]=='_') {
-      for(i++;i<name.size() && r<63;++i) {
-        if(name[i]=='_')
-          break;
-        scheme[r] = name[i];
-        ++r;
-        }
-      scheme[r] = '\0';
-      break;
-      }
-    }
-  }
-
 void Animation::Sequence::setupMoveTr() {
   data->setupMoveTr();
   }
@@ -580,6 +627,19 @@ void Animation::AnimData::setupMoveTr() {
     }
   }
 
+void Animation::AnimData::pack() {
+  // moveTr and translate are computed from raw samples: pack afterwards
+  const size_t sz = nodeIndex.size();
+  if(sz==0 || samples.empty() || samples.size()%sz!=0)
+    return;
+  const size_t frames = std::min<size_t>(numFrames, samples.size()/sz);
+  packed = PackedAnimation(samples.data(), uint32_t(frames), uint32_t(sz));
+  if(packed.isEmpty())
+    return;
+  samples.clear();
+  samples.shrink_to_fit();
+  }
+
 void Animation::AnimData::setupEvents(float fpsRate) {
   if(fpsRate<=0.f)
     return;
@@ -4,8 +4,12 @@
 #include <zenkit/ModelAnimation.hh>
 
 #include <Tempest/Vec>
+#include <unordered_map>
 #include <memory>
 
+#include "utils/symbol.h"
+#include "packedanimation.h"
+
 class Npc;
 class MdlVisual;
 class World;
@@ -42,7 +46,8 @@ class Animation final {
       Tempest::Vec3                               translate={};
       Tempest::Vec3                               moveTr={};
 
-      std::vector<zenkit::AnimationSample>        samples;
+      std::vector<zenkit::AnimationSample>        samples;   // empty, if packed
+      PackedAnimation                             packed;
       std::vector<uint32_t>                       nodeIndex;
       std::vector<Tempest::Vec3>                  tr;
       bool                                        hasMoveTr=false;
@@ -67,6 +72,7 @@ class Animation final {
 
       void                                        setupMoveTr();
       void                                        setupEvents(float fpsRate);
+      void                                        pack();
       };
 
     struct Sequence final {
@@ -93,9 +99,10 @@ class Animation final {
 
       Tempest::Vec3                          speed(uint64_t at, uint64_t dt) const;
       Tempest::Vec3                          translateXZ(uint64_t at) const;
-      void                                   schemeName(char buf[64]) const;
+      std::string_view                       schemeName() const { return scheme.str(); }
 
       std::string                            name, askName;
+      Symbol                                 id, ascId, scheme;
       const char*                            shortName = nullptr;
       uint32_t                               layer     = 0;
       zenkit::AnimationFlags                 flags     = zenkit::AnimationFlags::NONE;
@@ -105,6 +112,7 @@ class Animation final {
       bool                                   reverse   = false;
 
       std::string                            next;
+      Symbol                                 nextId;
       const Sequence*                        nextPtr = nullptr;
       const Animation*                       owner   = nullptr;
 
@@ -118,19 +126,31 @@ class Animation final {
       };
 
 
+    struct MemoryReport {
+      size_t                 total      = 0;
+      size_t                 samples    = 0; // raw and packed samples, as stored
+      size_t                 rawSamples = 0; // size of all samples unpacked
+      size_t                 sequences  = 0; // unique, without aliases
+      size_t                 packed     = 0;
+      PackedAnimation::Stats keys;
+      };
+
     Animation(zenkit::ModelScript &p, std::string_view name, bool ignoreErrChunks);
 
     const Sequence*    sequence(std::string_view name) const;
+    const Sequence*    sequence(Symbol name) const;
     const Sequence*    sequenceAsc(std::string_view name) const;
     void               debug() const;
     std::string_view   defaultMesh() const;
+    size_t             memoryUsage() const;
+    MemoryReport       memoryReport() const;
 
   private:
     Sequence&          loadMAN(const zenkit::MdsAnimation& hdr, std::string_view name);
     void               setupIndex();
 
-    mutable const Sequence*                  sqHot = nullptr;
     std::vector<Sequence>                    sequences;
+    std::unordered_map<Symbol,const Sequence*> byName, byAsc;
     std::vector<zenkit::MdsAnimationAlias>   ref;
     std::vector<std::string>                 mesh;
     zenkit::MdsSkeleton                      meshDef;
@@ -1,5 +1,8 @@
 #include "animationsolver.h"
 
+#include <shared_mutex>
+#include <unordered_map>
+
 #include "world/objects/interactive.h"
 #include "world/world.h"
 #include "game/serialize.h"
@@ -11,6 +14,52 @@
 
 using namespace Tempest;
 
+namespace {
+
+// candidate names of a weapon-specific format, resolved once: "T_%sATTACKL" -> T_1HATTACKL, T_ATTACKL, T_FISTATTACKL
+struct FrmNames final {
+  Symbol name[3];
+  };
+
+const FrmNames& frmNames(std::string_view format, WeaponState st) {
+  static std::shared_mutex                    sync;
+  static std::unordered_map<uint64_t,FrmNames> cache;
+
+  const uint64_t key = (uint64_t(Symbol(format).id())<<8) | uint64_t(st);
+  {
+  std::shared_lock<std::shared_mutex> lck(sync);
+  auto it = cache.find(key);
+  if(it!=cache.end())
+    return it->second;
+  }
+
+  static const char* weapon[] = {
+    "",
+    "FIST",
+    "1H",
+    "2H",
+    "BOW",
+    "CBOW",
+    "MAG"
+    };
+  char fmt[256] = {};
+  std::snprintf(fmt,sizeof(fmt),"%.*s",int(format.size()),format.data());
+
+  FrmNames ret;
+  char name[128]={};
+  std::snprintf(name,sizeof(name),fmt,weapon[int(st)],weapon[int(st)]);
+  ret.name[0] = Symbol(name);
+  std::snprintf(name,sizeof(name),fmt,"","");
+  ret.name[1] = Symbol(name);
+  std::snprintf(name,sizeof(name),fmt,"FIST","");
+  ret.name[2] = Symbol(name);
+
+  std::unique_lock<std::shared_mutex> lck(sync);
+  return cache.emplace(key,ret).first->second;
+  }
+
+}
+
 AnimationSolver::AnimationSolver() {
   }
 
@@ -422,28 +471,12 @@ const Animation::Sequence *AnimationSolver::solveAnim(Interactive *inter, Animat
     }
   }
 
-const Animation::Sequence* AnimationSolver::solveFrm(std::string_view fview, WeaponState st) const {
-  char format[256] = {};
-  std::snprintf(format,sizeof(format),"%.*s",int(fview.size()),fview.data());
-
-  static const char* weapon[] = {
-    "",
-    "FIST",
-    "1H",
-    "2H",
-    "BOW",
-    "CBOW",
-    "MAG"
-    };
-  char name[128]={};
-  std::snprintf(name,sizeof(name),format,weapon[int(st)],weapon[int(st)]);
-  if(auto ret=solveFrm(name))
-    return ret;
-  std::snprintf(name,sizeof(name),format,"","");
-  if(auto ret=solveFrm(name))
-    return ret;
-  std::snprintf(name,sizeof(name),format,"FIST","");
-  return solveFrm(name);
+const Animation::Sequence* AnimationSolver::solveFrm(std::string_view format, WeaponState st) const {
+  auto& n = frmNames(format,st);
+  for(auto& i:n.name)
+    if(auto ret=solveFrm(i))
+      return ret;
+  return nullptr;
   }
 
 const Animation::Sequence* AnimationSolver::solveMag(std::string_view fview, std::string_view spell) const {
@@ -466,9 +499,9 @@ void AnimationSolver::invalidateCache() {
   }
 
 const Animation::Sequence* AnimationSolver::solveNext(const Animation::Sequence& sq) const {
-  if(sq.next.empty())
+  if(sq.nextId.isEmpty())
     return nullptr;
-  std::string_view name = sq.next;
+  const Symbol name = sq.nextId;
   for(size_t i=overlay.size();i>0;){
     --i;
     if(overlay[i].skeleton->animation()==sq.owner && sq.nextPtr!=nullptr)
@@ -482,7 +515,11 @@ const Animation::Sequence* AnimationSolver::solveNext(const Animation::Sequence&
   }
 
 const Animation::Sequence *AnimationSolver::solveFrm(std::string_view name) const {
-  if(name.empty())
+  return solveFrm(Symbol::find(name));
+  }
+
+const Animation::Sequence* AnimationSolver::solveFrm(Symbol name) const {
+  if(name.isEmpty())
     return nullptr;
 
   for(size_t i=overlay.size();i>0;){
@@ -1,6 +1,15 @@
 #include "animmath.h"
 
 #include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#include <emmintrin.h>
+#define ANIM_SIMD_SSE
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ANIM_SIMD_NEON
+#endif
 
 static float mix(float x,float y,float a){
   return x+(y-x)*a;
@@ -43,3 +52,167 @@ Tempest::Matrix4x4 mkMatrix(const zenkit::AnimationSample& s) {
   return mkMatrix(s.rotation.x,s.rotation.y,s.rotation.z,s.rotation.w,
                   s.position.x,s.position.y,s.position.z);
   }
+
+namespace {
+
+#if defined(ANIM_SIMD_SSE)
+using F4 = __m128;
+inline F4   load (const float* p)  { return _mm_loadu_ps(p); }
+inline void store(float* p, F4 v)  { _mm_storeu_ps(p,v); }
+inline F4   set1 (float v)         { return _mm_set1_ps(v); }
+inline F4   add  (F4 a, F4 b)      { return _mm_add_ps(a,b); }
+inline F4   sub  (F4 a, F4 b)      { return _mm_sub_ps(a,b); }
+inline F4   mul  (F4 a, F4 b)      { return _mm_mul_ps(a,b); }
+inline F4   div  (F4 a, F4 b)      { return _mm_div_ps(a,b); }
+inline F4   sqrt4(F4 a)            { return _mm_sqrt_ps(a); }
+// flips sign of v, where s is negative
+inline F4   xorSign(F4 v, F4 s)    { return _mm_xor_ps(v,_mm_and_ps(s,_mm_set1_ps(-0.f))); }
+#elif defined(ANIM_SIMD_NEON)
+using F4 = float32x4_t;
+inline F4   load (const float* p)  { return vld1q_f32(p); }
+inline void store(float* p, F4 v)  { vst1q_f32(p,v); }
+inline F4   set1 (float v)         { return vdupq_n_f32(v); }
+inline F4   add  (F4 a, F4 b)      { return vaddq_f32(a,b); }
+inline F4   sub  (F4 a, F4 b)      { return vsubq_f32(a,b); }
+inline F4   mul  (F4 a, F4 b)      { return vmulq_f32(a,b); }
+inline F4   div  (F4 a, F4 b)      { return vdivq_f32(a,b); }
+inline F4   sqrt4(F4 a)            { return vsqrtq_f32(a); }
+inline F4   xorSign(F4 v, F4 s)    {
+  uint32x4_t m = vandq_u32(vreinterpretq_u32_f32(s),vdupq_n_u32(0x80000000u));
+  return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v),m));
+  }
+#else
+struct F4 { float v[4]; };
+inline F4   load (const float* p)  { return F4{{p[0],p[1],p[2],p[3]}}; }
+inline void store(float* p, F4 v)  { for(int i=0; i<4; ++i) p[i] = v.v[i]; }
+inline F4   set1 (float v)         { return F4{{v,v,v,v}}; }
+inline F4   add  (F4 a, F4 b)      { for(int i=0; i<4; ++i) a.v[i]+=b.v[i]; return a; }
+inline F4   sub  (F4 a, F4 b)      { for(int i=0; i<4; ++i) a.v[i]-=b.v[i]; return a; }
+inline F4   mul  (F4 a, F4 b)      { for(int i=0; i<4; ++i) a.v[i]*=b.v[i]; return a; }
+inline F4   div  (F4 a, F4 b)      { for(int i=0; i<4; ++i) a.v[i]/=b.v[i]; return a; }
+inline F4   sqrt4(F4 a)            { for(int i=0; i<4; ++i) a.v[i]=std::sqrt(a.v[i]); return a; }
+inline F4   xorSign(F4 v, F4 s)    { for(int i=0; i<4; ++i) if(std::signbit(s.v[i])) v.v[i]=-v.v[i]; return v; }
+#endif
+
+inline F4 lerp(F4 x, F4 y, F4 a) {
+  return add(x,mul(sub(y,x),a));
+  }
+
+// 4 samples in SoA form: rotation x,y,z,w, position x,y,z
+struct SampleSoA {
+  alignas(16) float v[7][4];
+
+  void gather(const zenkit::AnimationSample* s, size_t count) {
+    for(size_t k=0; k<4; ++k) {
+      auto& smp = s[k<count ? k : 0];
+      v[0][k] = smp.rotation.x;
+      v[1][k] = smp.rotation.y;
+      v[2][k] = smp.rotation.z;
+      v[3][k] = smp.rotation.w;
+      v[4][k] = smp.position.x;
+      v[5][k] = smp.position.y;
+      v[6][k] = smp.position.z;
+      }
+    }
+
+  void scatter(zenkit::AnimationSample* s, size_t count) const {
+    for(size_t k=0; k<4 && k<count; ++k) {
+      auto& smp = s[k];
+      smp.rotation.x = v[0][k];
+      smp.rotation.y = v[1][k];
+      smp.rotation.z = v[2][k];
+      smp.rotation.w = v[3][k];
+      smp.position.x = v[4][k];
+      smp.position.y = v[5][k];
+      smp.position.z = v[6][k];
+      }
+    }
+  };
+
+}
+
+void mixSamples(zenkit::AnimationSample* out, const zenkit::AnimationSample* x, const zenkit::AnimationSample* y,
+                float a, size_t count) {
+  const F4 ta = set1(a);
+  for(size_t i=0; i<count; i+=4) {
+    const size_t cnt = std::min<size_t>(4,count-i);
+    SampleSoA sx, sy, r;
+    sx.gather(x+i,cnt);
+    sy.gather(y+i,cnt);
+
+    F4 qx0 = load(sx.v[0]), qy0 = load(sx.v[1]), qz0 = load(sx.v[2]), qw0 = load(sx.v[3]);
+    F4 qx1 = load(sy.v[0]), qy1 = load(sy.v[1]), qz1 = load(sy.v[2]), qw1 = load(sy.v[3]);
+
+    // shortest path
+    F4 dot = add(add(mul(qx0,qx1),mul(qy0,qy1)),add(mul(qz0,qz1),mul(qw0,qw1)));
+    qx1 = xorSign(qx1,dot);
+    qy1 = xorSign(qy1,dot);
+    qz1 = xorSign(qz1,dot);
+    qw1 = xorSign(qw1,dot);
+
+    F4 qx = lerp(qx0,qx1,ta), qy = lerp(qy0,qy1,ta), qz = lerp(qz0,qz1,ta), qw = lerp(qw0,qw1,ta);
+    F4 len = sqrt4(add(add(mul(qx,qx),mul(qy,qy)),add(mul(qz,qz),mul(qw,qw))));
+    F4 inv = div(set1(1.f),len);
+
+    store(r.v[0],mul(qx,inv));
+    store(r.v[1],mul(qy,inv));
+    store(r.v[2],mul(qz,inv));
+    store(r.v[3],mul(qw,inv));
+    for(int c=4; c<7; ++c)
+      store(r.v[c],lerp(load(sx.v[c]),load(sy.v[c]),ta));
+    r.scatter(out+i,cnt);
+    }
+  }
+
+void mkMatrices(Tempest::Matrix4x4* out, const zenkit::AnimationSample* s, size_t count) {
+  const F4 two = set1(2.f);
+  for(size_t i=0; i<count; i+=4) {
+    const size_t cnt = std::min<size_t>(4,count-i);
+    SampleSoA smp;
+    smp.gather(s+i,cnt);
+
+    const F4 x = load(smp.v[0]), y = load(smp.v[1]), z = load(smp.v[2]), w = load(smp.v[3]);
+    const F4 xx = mul(x,x), yy = mul(y,y), zz = mul(z,z), ww = mul(w,w);
+    const F4 xy = mul(x,y), xz = mul(x,z), yz = mul(y,z);
+    const F4 wx = mul(w,x), wy = mul(w,y), wz = mul(w,z);
+
+    // same layout as scalar mkMatrix: m[column][row]
+    alignas(16) float m[12][4];
+    store(m[ 0], sub(add(ww,xx),add(yy,zz)));
+    store(m[ 1], mul(two,sub(xy,wz)));
+    store(m[ 2], mul(two,add(xz,wy)));
+    store(m[ 3], mul(two,add(xy,wz)));
+    store(m[ 4], sub(add(ww,yy),add(xx,zz)));
+    store(m[ 5], mul(two,sub(yz,wx)));
+    store(m[ 6], mul(two,sub(xz,wy)));
+    store(m[ 7], mul(two,add(yz,wx)));
+    store(m[ 8], sub(add(ww,zz),add(xx,yy)));
+
+    for(size_t k=0; k<cnt; ++k) {
+      float mat[4][4] = {
+        {m[0][k], m[1][k], m[2][k], 0},
+        {m[3][k], m[4][k], m[5][k], 0},
+        {m[6][k], m[7][k], m[8][k], 0},
+        {smp.v[4][k], smp.v[5][k], smp.v[6][k], 1},
+        };
+      out[i+k] = Tempest::Matrix4x4(reinterpret_cast<float*>(mat));
+      }
+    }
+  }
+
+void mulMatrix(Tempest::Matrix4x4& out, const Tempest::Matrix4x4& a, const Tempest::Matrix4x4& b) {
+  // column-major, same as Tempest::Matrix4x4::mul
+  static_assert(sizeof(Tempest::Matrix4x4)==sizeof(float[16]));
+  const float* ma = reinterpret_cast<const float*>(&a);
+  const float* mb = reinterpret_cast<const float*>(&b);
+
+  const F4 a0 = load(ma+0), a1 = load(ma+4), a2 = load(ma+8), a3 = load(ma+12);
+  alignas(16) float r[16];
+  for(int c=0; c<4; ++c) {
+    const float* bc = mb+c*4;
+    F4 v = add(add(mul(a0,set1(bc[0])),mul(a1,set1(bc[1]))),
+               add(mul(a2,set1(bc[2])),mul(a3,set1(bc[3]))));
+    store(r+c*4,v);
+    }
+  out = Tempest::Matrix4x4(r);
+  }
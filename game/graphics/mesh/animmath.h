@@ -7,3 +7,11 @@
 
 zenkit::AnimationSample mix(const zenkit::AnimationSample& x, const zenkit::AnimationSample& y, float a);
 Tempest::Matrix4x4      mkMatrix(const zenkit::AnimationSample& s);
+
+// batched variants, 4 samples per simd-lane (sse/neon, scalar fallback)
+// frame interpolation: rotation uses normalized lerp, along shortest path
+void mixSamples(zenkit::AnimationSample* out, const zenkit::AnimationSample* x, const zenkit::AnimationSample* y,
+                float a, size_t count);
+void mkMatrices(Tempest::Matrix4x4* out, const zenkit::AnimationSample* s, size_t count);
+// out = a*b; out may alias a or b
+void mulMatrix (Tempest::Matrix4x4& out, const Tempest::Matrix4x4& a, const Tempest::Matrix4x4& b);
@@ -0,0 +1,324 @@
+#include "packedanimation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// greedy key reduction spans are checked in O(span^2)
+constexpr uint32_t MaxSpan   = 256;
+constexpr float    QuatRange = 0.70710678f; // |smallest three| <= 1/sqrt(2)
+constexpr uint32_t QuatMax   = (1u<<15)-1;
+constexpr uint32_t PosMax    = (1u<<16)-1;
+
+struct Quat {
+  float v[4] = {};
+  };
+
+struct Pos {
+  float v[3] = {};
+  };
+
+float dot(const Quat& a, const Quat& b) {
+  return a.v[0]*b.v[0] + a.v[1]*b.v[1] + a.v[2]*b.v[2] + a.v[3]*b.v[3];
+  }
+
+// squared chord between unit quaternions on shortest path; stable for small angles, unlike acos(dot)
+float chord2(const Quat& a, const Quat& b) {
+  const float s = dot(a,b)<0.f ? -1.f : 1.f;
+  float       r = 0;
+  for(int i=0; i<4; ++i) {
+    const float d = a.v[i]-b.v[i]*s;
+    r += d*d;
+    }
+  return r;
+  }
+
+void normalize(float* q) {
+  float l = std::sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+  if(l<=0.f) {
+    q[0] = q[1] = q[2] = 0.f;
+    q[3] = 1.f;
+    return;
+    }
+  l = 1.f/l;
+  for(int i=0; i<4; ++i)
+    q[i] *= l;
+  }
+
+// normalized lerp along shortest path, same as mixSamples does for frames
+void nlerp(float* out, const float* a, const float* b, float t) {
+  const float s = (a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3])<0.f ? -1.f : 1.f;
+  for(int i=0; i<4; ++i)
+    out[i] = a[i] + (b[i]*s-a[i])*t;
+  normalize(out);
+  }
+
+float frameLerp(uint32_t a, uint32_t b, uint32_t f) {
+  return float(f-a)/float(b-a);
+  }
+
+template<class F>
+void reduceKeys(std::vector<uint32_t>& keys, uint32_t numFrames, const F& fits) {
+  keys.clear();
+  keys.push_back(0);
+  for(uint32_t k=0; k+1<numFrames;) {
+    uint32_t e = k+1;
+    while(e+1<numFrames && e+1-k<=MaxSpan && fits(k,e+1))
+      ++e;
+    keys.push_back(e);
+    k = e;
+    }
+  }
+
+}
+
+PackedAnimation::PackedAnimation(const zenkit::AnimationSample* samples, uint32_t frames, uint32_t numNodes)
+  :PackedAnimation(samples,frames,numNodes,Tolerance()) {
+  }
+
+PackedAnimation::PackedAnimation(const zenkit::AnimationSample* samples, uint32_t frames, uint32_t numNodes,
+                                 const Tolerance& tol) {
+  if(frames==0 || numNodes==0 || frames>std::numeric_limits<uint16_t>::max())
+    return;
+  numFrames = frames;
+  nodes.resize(numNodes);
+
+  // rotation by angle moves unit quaternion by chord of 2*sin(angle/4)
+  const float chord = 2.f*std::sin(tol.rotation*float(M_PI)/720.f);
+  for(uint32_t i=0; i<numNodes; ++i) {
+    packRot(nodes[i],samples+i,numNodes,chord*chord);
+    packPos(nodes[i],samples+i,numNodes,tol.position);
+    }
+
+  rotFrame.shrink_to_fit();
+  rotKey  .shrink_to_fit();
+  posFrame.shrink_to_fit();
+  posKey  .shrink_to_fit();
+  }
+
+PackedAnimation::Key48 PackedAnimation::packQuat(const float q[4]) {
+  uint32_t big = 0;
+  for(uint32_t i=1; i<4; ++i)
+    if(std::fabs(q[i])>std::fabs(q[big]))
+      big = i;
+  // q and -q are same rotation: drop sign of largest component
+  const float sign = q[big]<0.f ? -1.f : 1.f;
+
+  uint64_t bits  = big;
+  uint32_t shift = 2;
+  for(uint32_t i=0; i<4; ++i) {
+    if(i==big)
+      continue;
+    float    v = std::clamp(q[i]*sign/QuatRange*0.5f+0.5f, 0.f, 1.f);
+    uint64_t u = uint64_t(std::lround(v*float(QuatMax)));
+    bits  |= (u << shift);
+    shift += 15;
+    }
+
+  Key48 k;
+  k.v[0] = uint16_t(bits);
+  k.v[1] = uint16_t(bits >> 16);
+  k.v[2] = uint16_t(bits >> 32);
+  return k;
+  }
+
+void PackedAnimation::unpackQuat(float q[4], const Key48& k) {
+  // component order of the smallest three, for each position of the largest one
+  static const uint8_t slot[4][3] = {{1,2,3},{0,2,3},{0,1,3},{0,1,2}};
+  static const float   mul        = 2.f*QuatRange/float(QuatMax);
+
+  const uint64_t bits = uint64_t(k.v[0]) | (uint64_t(k.v[1]) << 16) | (uint64_t(k.v[2]) << 32);
+  const uint32_t big  = uint32_t(bits & 0x3);
+  const float    a    = float((bits >>  2) & QuatMax)*mul - QuatRange;
+  const float    b    = float((bits >> 17) & QuatMax)*mul - QuatRange;
+  const float    c    = float((bits >> 32) & QuatMax)*mul - QuatRange;
+  q[slot[big][0]] = a;
+  q[slot[big][1]] = b;
+  q[slot[big][2]] = c;
+  q[big]          = std::sqrt(std::max(0.f, 1.f-a*a-b*b-c*c));
+  }
+
+void PackedAnimation::packRot(Node& n, const zenkit::AnimationSample* samples, uint32_t stride, float tol2) {
+  std::vector<Quat>  raw(numFrames), dec(numFrames);
+  std::vector<Key48> enc(numFrames);
+  for(uint32_t f=0; f<numFrames; ++f) {
+    auto& r = samples[size_t(f)*stride].rotation;
+    raw[f].v[0] = r.x;
+    raw[f].v[1] = r.y;
+    raw[f].v[2] = r.z;
+    raw[f].v[3] = r.w;
+    normalize(raw[f].v);
+    enc[f] = packQuat(raw[f].v);
+    unpackQuat(dec[f].v,enc[f]);
+    }
+
+  bool isConst = true;
+  for(uint32_t f=0; f<numFrames && isConst; ++f)
+    isConst = chord2(dec[0],raw[f])<=tol2;
+
+  std::vector<uint32_t> keys = {0};
+  if(!isConst) {
+    reduceKeys(keys,numFrames,[&](uint32_t a, uint32_t b) {
+      for(uint32_t f=a+1; f<b; ++f) {
+        Quat q;
+        nlerp(q.v,dec[a].v,dec[b].v,frameLerp(a,b,f));
+        if(chord2(q,raw[f])>tol2)
+          return false;
+        }
+      return true;
+      });
+    }
+
+  n.rot.first = uint32_t(rotKey.size());
+  n.rot.count = uint32_t(keys.size());
+  for(auto k:keys) {
+    rotFrame.push_back(uint16_t(k));
+    rotKey  .push_back(enc[k]);
+    }
+  }
+
+void PackedAnimation::packPos(Node& n, const zenkit::AnimationSample* samples, uint32_t stride, float tol) {
+  std::vector<Pos> raw(numFrames), dec(numFrames);
+  for(uint32_t f=0; f<numFrames; ++f) {
+    auto& p = samples[size_t(f)*stride].position;
+    raw[f].v[0] = p.x;
+    raw[f].v[1] = p.y;
+    raw[f].v[2] = p.z;
+    }
+
+  for(int i=0; i<3; ++i) {
+    float mi = raw[0].v[i], ma = raw[0].v[i];
+    for(auto& r:raw) {
+      mi = std::min(mi,r.v[i]);
+      ma = std::max(ma,r.v[i]);
+      }
+    n.posMin  [i] = mi;
+    n.posScale[i] = (ma-mi)/float(PosMax);
+    }
+
+  std::vector<Key48> enc(numFrames);
+  for(uint32_t f=0; f<numFrames; ++f) {
+    for(int i=0; i<3; ++i) {
+      uint32_t u = 0;
+      if(n.posScale[i]>0.f)
+        u = uint32_t(std::clamp<long>(std::lround((raw[f].v[i]-n.posMin[i])/n.posScale[i]), 0, long(PosMax)));
+      enc[f].v[i] = uint16_t(u);
+      dec[f].v[i] = n.posMin[i] + float(u)*n.posScale[i];
+      }
+    }
+
+  const float tol2  = tol*tol;
+  auto        error = [](const Pos& a, const Pos& b) {
+    float dx = a.v[0]-b.v[0], dy = a.v[1]-b.v[1], dz = a.v[2]-b.v[2];
+    return dx*dx + dy*dy + dz*dz;
+    };
+
+  bool isConst = true;
+  for(uint32_t f=0; f<numFrames && isConst; ++f)
+    isConst = error(dec[0],raw[f])<=tol2;
+
+  std::vector<uint32_t> keys = {0};
+  if(!isConst) {
+    reduceKeys(keys,numFrames,[&](uint32_t a, uint32_t b) {
+      for(uint32_t f=a+1; f<b; ++f) {
+        const float t = frameLerp(a,b,f);
+        Pos p;
+        for(int i=0; i<3; ++i)
+          p.v[i] = dec[a].v[i] + (dec[b].v[i]-dec[a].v[i])*t;
+        if(error(p,raw[f])>tol2)
+          return false;
+        }
+      return true;
+      });
+    }
+
+  n.pos.first = uint32_t(posKey.size());
+  n.pos.count = uint32_t(keys.size());
+  for(auto k:keys) {
+    posFrame.push_back(uint16_t(k));
+    posKey  .push_back(enc[k]);
+    }
+  }
+
+size_t PackedAnimation::keyAt(const uint16_t* frames, const Track& t, uint32_t frame, uint32_t numFrames) {
+  // keys are spread roughly even: start from proportional guess and walk, instead of binary search
+  auto   b = frames+t.first;
+  size_t i = size_t(frame)*(t.count-1)/numFrames;
+  while(i>0 && b[i]>frame)
+    --i;
+  while(i+1<t.count && b[i+1]<=frame)
+    ++i;
+  return i;
+  }
+
+void PackedAnimation::decodeRot(float q[4], const Track& t, uint32_t frame) const {
+  const size_t k = t.count>1 ? keyAt(rotFrame.data(),t,frame,numFrames) : 0;
+  if(k+1>=t.count) {
+    unpackQuat(q,rotKey[t.first+k]);
+    return;
+    }
+  const uint32_t fa = rotFrame[t.first+k], fb = rotFrame[t.first+k+1];
+  float a[4], b[4];
+  unpackQuat(a,rotKey[t.first+k]);
+  unpackQuat(b,rotKey[t.first+k+1]);
+  nlerp(q,a,b,frameLerp(fa,fb,frame));
+  }
+
+void PackedAnimation::decodePos(float p[3], const Node& n, uint32_t frame) const {
+  const Track& t = n.pos;
+  const size_t k = t.count>1 ? keyAt(posFrame.data(),t,frame,numFrames) : 0;
+  const Key48& a = posKey[t.first+k];
+  if(k+1>=t.count) {
+    for(int i=0; i<3; ++i)
+      p[i] = n.posMin[i] + float(a.v[i])*n.posScale[i];
+    return;
+    }
+  const Key48& b  = posKey[t.first+k+1];
+  const float  tk = frameLerp(posFrame[t.first+k],posFrame[t.first+k+1],frame);
+  for(int i=0; i<3; ++i) {
+    const float u = float(a.v[i]) + (float(b.v[i])-float(a.v[i]))*tk;
+    p[i] = n.posMin[i] + u*n.posScale[i];
+    }
+  }
+
+void PackedAnimation::sample(zenkit::AnimationSample* out, uint32_t frame, size_t count) const {
+  if(numFrames==0)
+    return;
+  frame = std::min(frame,numFrames-1);
+  count = std::min(count,nodes.size());
+  for(size_t i=0; i<count; ++i) {
+    float q[4], p[3];
+    decodeRot(q,nodes[i].rot,frame);
+    decodePos(p,nodes[i],frame);
+    auto& s = out[i];
+    s.rotation.x = q[0];
+    s.rotation.y = q[1];
+    s.rotation.z = q[2];
+    s.rotation.w = q[3];
+    s.position.x = p[0];
+    s.position.y = p[1];
+    s.position.z = p[2];
+    }
+  }
+
+size_t PackedAnimation::memoryUsage() const {
+  return nodes.size()*sizeof(Node) +
+         (rotFrame.size() + posFrame.size())*sizeof(uint16_t) +
+         (rotKey.size()   + posKey.size())*sizeof(Key48);
+  }
+
+PackedAnimation::Stats PackedAnimation::stats() const {
+  Stats st;
+  st.tracks  = nodes.size()*2;
+  st.keys    = rotKey.size() + posKey.size();
+  st.rawKeys = st.tracks*numFrames;
+  for(auto& n:nodes) {
+    if(n.rot.count==1)
+      st.constTracks++;
+    if(n.pos.count==1)
+      st.constTracks++;
+    }
+  return st;
+  }
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <zenkit/ModelAnimation.hh>
+
+#include <cstdint>
+#include <vector>
+
+// compressed skeletal animation samples:
+// rotations are smallest-three quaternions in 48 bits, positions are 16-bit per axis in per-track range;
+// frames, that linear interpolation of neighbour keys reproduces within tolerance, are dropped
+class PackedAnimation final {
+  public:
+    struct Tolerance {
+      float rotation = 0.1f; // degrees
+      float position = 0.1f; // world units
+      };
+
+    struct Stats {
+      size_t tracks      = 0; // rotation and position tracks
+      size_t constTracks = 0;
+      size_t keys        = 0;
+      size_t rawKeys     = 0;
+      };
+
+    PackedAnimation() = default;
+    // samples are frame-major: numFrames*numNodes
+    PackedAnimation(const zenkit::AnimationSample* samples, uint32_t numFrames, uint32_t numNodes);
+    PackedAnimation(const zenkit::AnimationSample* samples, uint32_t numFrames, uint32_t numNodes, const Tolerance& tol);
+
+    bool     isEmpty()    const { return numFrames==0; }
+    uint32_t frameCount() const { return numFrames; }
+    uint32_t nodeCount()  const { return uint32_t(nodes.size()); }
+
+    // decodes first count nodes of frame; no allocations
+    void     sample(zenkit::AnimationSample* out, uint32_t frame, size_t count) const;
+
+    size_t   memoryUsage() const;
+    Stats    stats() const;
+
+  private:
+    struct Key48 {
+      uint16_t v[3] = {};
+      };
+
+    struct Track {
+      uint32_t first = 0;
+      uint32_t count = 0;
+      };
+
+    struct Node {
+      Track rot, pos;
+      float posMin  [3] = {};
+      float posScale[3] = {};
+      };
+
+    static Key48 packQuat  (const float q[4]);
+    static void  unpackQuat(float q[4], const Key48& k);
+
+    void         packRot(Node& n, const zenkit::AnimationSample* samples, uint32_t stride, float chord2);
+    void         packPos(Node& n, const zenkit::AnimationSample* samples, uint32_t stride, float tol);
+
+    void         decodeRot(float q[4], const Track& t, uint32_t frame) const;
+    void         decodePos(float p[3], const Node&  n, uint32_t frame) const;
+    static size_t keyAt(const uint16_t* frames, const Track& t, uint32_t frame, uint32_t numFrames);
+
+    uint32_t              numFrames = 0;
+    std::vector<Node>     nodes;
+    std::vector<uint16_t> rotFrame, posFrame;
+    std::vector<Key48>    rotKey,   posKey;
+  };
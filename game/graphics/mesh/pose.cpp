@@ -347,7 +347,7 @@ bool Pose::updateFrame(const Animation::Sequence &s, BodyState bs, uint64_t sBle
   auto&        d         = *s.data;
   const size_t numFrames = d.numFrames;
   const size_t idSize    = d.nodeIndex.size();
-  if(numFrames==0 || idSize==0 || d.samples.size()%idSize!=0)
+  if(numFrames==0 || idSize==0 || (d.packed.isEmpty() && d.samples.size()%idSize!=0))
     return false;
   if(numFrames==1 && !needToUpdate)
     return false;
@@ -375,17 +375,29 @@ bool Pose::updateFrame(const Animation::Sequence &s, BodyState bs, uint64_t sBle
     frameB = d.numFrames-1-frameB;
     }
 
-  auto* sampleA = &d.samples[size_t(frameA*idSize)];
-  auto* sampleB = &d.samples[size_t(frameB*idSize)];
-
   const uint64_t blendMax = std::max(s.blendOut,s.blendIn);
   const uint64_t blend    = std::max<uint64_t>(0, now-sBlend);
 
-  for(size_t i=0; i<idSize; ++i) {
+  // frames A/B are decoded in one simd batch
+  const size_t            count = std::min(idSize,Resources::MAX_NUM_SKELETAL_NODES);
+  zenkit::AnimationSample frame[Resources::MAX_NUM_SKELETAL_NODES];
+  if(d.packed.isEmpty()) {
+    auto* sampleA = &d.samples[size_t(frameA*idSize)];
+    auto* sampleB = &d.samples[size_t(frameB*idSize)];
+    mixSamples(frame,sampleA,sampleB,a,count);
+    } else {
+    zenkit::AnimationSample sampleA[Resources::MAX_NUM_SKELETAL_NODES];
+    zenkit::AnimationSample sampleB[Resources::MAX_NUM_SKELETAL_NODES];
+    d.packed.sample(sampleA,uint32_t(frameA),count);
+    d.packed.sample(sampleB,uint32_t(frameB),count);
+    mixSamples(frame,sampleA,sampleB,a,count);
+    }
+
+  for(size_t i=0; i<count; ++i) {
     size_t idx = d.nodeIndex[i];
     if(idx>=numBones)
       continue;
-    auto smp = mix(sampleA[i],sampleB[i],a);
+    auto smp = frame[i];
     if(i==0) {
       if(bs==BS_CLIMB)
         smp.position.y = trY;
@@ -430,15 +442,21 @@ void Pose::mkSkeleton(const Tempest::Matrix4x4& mt) {
 void Pose::implMkSkeleton(const Matrix4x4 &mt) {
   if(skeleton==nullptr)
     return;
-  auto& nodes      = skeleton->nodes;
-  auto  BIP01_HEAD = skeleton->BIP01_HEAD;
-  for(size_t i=0; i<nodes.size(); ++i) {
+  auto&        nodes      = skeleton->nodes;
+  auto         BIP01_HEAD = skeleton->BIP01_HEAD;
+  const size_t count      = std::min(nodes.size(),Resources::MAX_NUM_SKELETAL_NODES);
+
+  // local transforms in one batch, then parents-first pass
+  Matrix4x4 local[Resources::MAX_NUM_SKELETAL_NODES];
+  mkMatrices(local,base,count);
+
+  for(size_t i=0; i<count; ++i) {
     size_t parent = nodes[i].parent;
-    auto   mat    = hasSamples[i] ? mkMatrix(base[i]) : nodes[i].tr;
+    auto&  mat    = hasSamples[i] ? local[i] : nodes[i].tr;
 
     if(parent<Resources::MAX_NUM_SKELETAL_NODES)
-      tr[i] = tr[parent]*mat; else
-      tr[i] = mt*mat;
+      mulMatrix(tr[i],tr[parent],mat); else
+      mulMatrix(tr[i],mt,mat);
 
     if(i==BIP01_HEAD && (headRotX!=0 || headRotY!=0)) {
       Matrix4x4& m = tr[i];
@@ -473,8 +491,7 @@ const Animation::Sequence* Pose::solveNext(const AnimationSolver &solver, const
       sB--;
       nextState = itemUseSt-1;
       }
-    char scheme[64]={};
-    sq->schemeName(scheme);
+    std::string_view scheme = sq->schemeName();
 
     const Animation::Sequence* ret = nullptr;
     if(itemUseSt>itemUseDestSt) {
@@ -750,7 +767,7 @@ const Animation::Sequence* Pose::continueCombo(const AnimationSolver &solver, co
     }
 
   if(!(d.defWindow[id+0]<t && t<=d.defWindow[id+1])) {
-    if(prev->seq->name==sq->name && sq->data->defHitEnd.size()>0)
+    if(prev->seq->id==sq->id && sq->data->defHitEnd.size()>0)
       combo.setBreak();
     return nullptr;
     }
@@ -758,7 +775,7 @@ const Animation::Sequence* Pose::continueCombo(const AnimationSolver &solver, co
   if(combo.isBreak())
     return nullptr;
 
-  if(prev->seq->name!=sq->name) {
+  if(prev->seq->id!=sq->id) {
     startAnim(solver,sq,prev->comb,bs,Pose::Force,tickCount);
     combo = ComboState();
     return sq;
@@ -829,7 +846,7 @@ void Pose::setAnimRotate(const AnimationSolver &solver, Npc &npc, WeaponState fi
     sq = solver.solveAnim(AnimationSolver::Anim::RotR,fightMode,npc.walkMode(),*this);
     }
   if(rotation!=nullptr) {
-    if(sq!=nullptr && rotation->name==sq->name)
+    if(sq!=nullptr && rotation->id==sq->id)
       return;
     if(!stopAnim(rotation->name))
       return;
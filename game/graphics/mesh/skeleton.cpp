@@ -71,6 +71,12 @@ const Animation::Sequence* Skeleton::sequence(std::string_view name) const {
   return nullptr;
   }
 
+const Animation::Sequence* Skeleton::sequence(Symbol name) const {
+  if(anim!=nullptr)
+    return anim->sequence(name);
+  return nullptr;
+  }
+
 void Skeleton::debug() const {
   if(anim!=nullptr)
     anim->debug();
@@ -33,6 +33,7 @@ class Skeleton final {
 
     std::string_view                name() const { return fileName; }
     const Animation::Sequence*      sequence(std::string_view name) const;
+    const Animation::Sequence*      sequence(Symbol name) const;
     const Animation*                animation() const { return anim; }
     std::string_view                defaultMesh() const;
 
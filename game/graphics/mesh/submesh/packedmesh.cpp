@@ -4,9 +4,10 @@
 #include <Tempest/Log>
 #include <fstream>
 #include <algorithm>
+#include <cstring>
 
 #include "game/compatibility/phoenix.h"
-#include "gothic.h"
+#include "utils/workers.h"
 
 using namespace Tempest;
 
@@ -42,45 +43,315 @@ static bool isVisuallySame(const zenkit::Material& a, const zenkit::Material& b)
     a.default_mapping              == b.default_mapping;
   }
 
-struct PackedMesh::PrimitiveHeap {
-  using value_type = std::pair<uint64_t,uint32_t>;
-  using iterator   = std::vector<value_type>::iterator;
+// meshlets are grown over shared vertices, preferring triangles that add the fewest new vertices;
+// next meshlet is seeded at the border of previous one, in the most 'cornered' triangle, to avoid fragmentation;
+// triangles are renumbered in spatial (morton) order: for memory locality, fallback seeds and disconnected fill-ins
+struct PackedMesh::MeshletBuilder {
+  MeshletBuilder(const std::vector<glm::vec3>& vbo, const std::vector<Vert>& src)
+    :vbo(vbo), src(src), triCount(src.size()/3) {
+    buildAdjacency(buildOrder());
+    }
 
-  std::vector<std::pair<uint64_t,uint32_t>>  data;
+  std::vector<Meshlet> build() {
+    std::vector<Meshlet> ret;
+    ret.reserve(triCount/(MaxPrim/2)+1);
+    while(true) {
+      uint32_t t = NoTri;
+      if(active.indSz==0) {
+        t = pickSeed();
+        if(t==NoTri)
+          break;
+        }
+      else if(active.indSz+3<=MaxInd) {
+        t = pickAdjacent();
+        if(t==NoTri)
+          t = pickNearby();
+        }
+      if(t==NoTri) {
+        flush(ret);
+        continue;
+        }
+      add(t);
+      }
+    flush(ret);
+    return ret;
+    }
+
+  private:
+    static constexpr uint32_t NoTri        = uint32_t(-1);
+    static constexpr uint8_t  NoSlot       = 0xFF;
+    static constexpr size_t   SearchWindow = 128;
+
+    const std::vector<glm::vec3>& vbo;
+    const std::vector<Vert>&      src;
+    const size_t                  triCount = 0;
+
+    std::vector<Vert>      verts;     // unique (position, feature) pairs
+    std::vector<uint32_t>  tri;       // 3 indices into verts per triangle, morton order
+    std::vector<uint32_t>  adjOffset; // vertex -> adjacent triangles, CSR
+    std::vector<uint32_t>  adj;
+    std::vector<glm::vec3> center;
+    std::vector<uint32_t>  used;      // generation (meshlet), that triangle was added to; 0 - unused
+    std::vector<uint8_t>   slot;      // vertex -> index in active meshlet
+    std::vector<uint32_t>  live;      // vertex -> count of unused adjacent triangles
+
+    Meshlet                active;
+    uint32_t               activeVert[MaxVert] = {};
+    glm::vec3              activeSum  = {};
+    std::vector<uint32_t>  front[3];  // adjacent triangles, by count of vertices they'd add; may be stale
+    std::vector<uint32_t>  border;    // unused candidates of previous meshlet
+    glm::vec3              borderMid  = {};
+    uint32_t               generation = 1;
+    size_t                 cursor     = 0;
+    uint32_t               last       = 0;
+
+    // morton order -> source triangle
+    std::vector<uint32_t> buildOrder() {
+      std::vector<glm::vec3> c(triCount);
+      glm::vec3 bmin = {}, bmax = {};
+      for(size_t i=0; i<triCount; ++i) {
+        auto& a = vbo[src[i*3+0].first];
+        auto& b = vbo[src[i*3+1].first];
+        auto& d = vbo[src[i*3+2].first];
+        c[i] = (a+b+d)/3.f;
+        bmin = (i==0) ? c[i] : glm::min(bmin,c[i]);
+        bmax = (i==0) ? c[i] : glm::max(bmax,c[i]);
+        }
+
+      const glm::vec3 ext   = glm::max(bmax-bmin, glm::vec3(1.f));
+      const glm::vec3 scale = glm::vec3(1023.f)/ext;
+      std::vector<uint64_t> code(triCount);
+      for(size_t i=0; i<triCount; ++i) {
+        auto q = (c[i]-bmin)*scale;
+        code[i] = mkUInt64(morton3(uint32_t(q.x),uint32_t(q.y),uint32_t(q.z)), uint32_t(i));
+        }
+      std::sort(code.begin(), code.end());
 
-  void   reserve(size_t n) { data.reserve(n*3); }
+      std::vector<uint32_t> order(triCount);
+      center.resize(triCount);
+      for(size_t i=0; i<triCount; ++i) {
+        order [i] = uint32_t(code[i]);
+        center[i] = c[order[i]];
+        }
+      return order;
+      }
 
-  void   clear() { data.clear();        }
-  size_t size()  { return data.size();  }
-  bool   empty() { return data.empty(); }
+    void buildAdjacency(const std::vector<uint32_t>& order) {
+      // vertices are numbered by first use; same position with different features are linked in a list
+      static constexpr uint32_t NoVert = uint32_t(-1);
+      std::vector<uint32_t> posHead(vbo.size(), NoVert);
+      std::vector<uint32_t> next;
+      next .reserve(src.size()/2);
+      verts.reserve(src.size()/2);
+
+      tri.resize(src.size());
+      for(size_t i=0; i<triCount; ++i) {
+        for(size_t r=0; r<3; ++r) {
+          const Vert& v  = src[order[i]*3+r];
+          uint32_t    id = posHead[v.first];
+          while(id!=NoVert && verts[id].second!=v.second)
+            id = next[id];
+          if(id==NoVert) {
+            id = uint32_t(verts.size());
+            verts.push_back(v);
+            next.push_back(posHead[v.first]);
+            posHead[v.first] = id;
+            }
+          tri[i*3+r] = id;
+          }
+        }
 
-  void   push_back(const value_type& v) { data.push_back(v); }
+      adjOffset.assign(verts.size()+1, 0);
+      for(auto v:tri)
+        adjOffset[v+1]++;
+      for(size_t i=1; i<adjOffset.size(); ++i)
+        adjOffset[i] += adjOffset[i-1];
+
+      std::vector<uint32_t> at(adjOffset.begin(), adjOffset.end()-1);
+      adj.resize(tri.size());
+      for(size_t i=0; i<tri.size(); ++i)
+        adj[at[tri[i]]++] = uint32_t(i/3);
+
+      used.assign(triCount, 0);
+      slot.assign(verts.size(), NoSlot);
+      live.resize(verts.size());
+      for(size_t i=0; i<verts.size(); ++i)
+        live[i] = adjOffset[i+1]-adjOffset[i];
+      }
 
-  void   sort() {
-    std::sort(data.begin(), data.end(), [](const value_type& l, const value_type& r){
-      return l.first<r.first;
-      });
-    }
+    static uint32_t spread3(uint32_t x) {
+      x &= 0x3FF;
+      x = (x | (x<<16)) & 0x030000FF;
+      x = (x | (x<< 8)) & 0x0300F00F;
+      x = (x | (x<< 4)) & 0x030C30C3;
+      x = (x | (x<< 2)) & 0x09249249;
+      return x;
+      }
 
-  iterator begin() { return data.begin(); }
-  iterator end()   { return data.end();   }
+    static uint32_t morton3(uint32_t x, uint32_t y, uint32_t z) {
+      return spread3(x) | (spread3(y)<<1) | (spread3(z)<<2);
+      }
 
-  iterator erase(iterator& i) {
-    return data.erase(i);
-    }
+    uint32_t newVerts(uint32_t t) const {
+      const uint32_t a = tri[t*3+0], b = tri[t*3+1], c = tri[t*3+2];
+      uint32_t n = 0;
+      if(slot[a]==NoSlot)
+        ++n;
+      if(slot[b]==NoSlot && b!=a)
+        ++n;
+      if(slot[c]==NoSlot && c!=a && c!=b)
+        ++n;
+      return n;
+      }
 
-  std::pair<iterator,iterator> equal_range(uint64_t v) {
-    auto l = std::lower_bound(data.begin(), data.end(), v, [](const value_type& x, uint64_t v){
-      return x.first<v;
-      });
-    auto r = l; ++r;
-    while(r!=data.end()) {
-      if(r->first>v)
-        break;
-      ++r;
+    glm::vec3 activeCenter() const {
+      return activeSum/float(active.indSz/3);
+      }
+
+    uint32_t pickSeed() {
+      uint32_t best     = NoTri;
+      uint32_t bestLive = 0;
+      float    bestDist = 0;
+      for(auto t:border) {
+        if(used[t]!=0)
+          continue;
+        const uint32_t lv   = live[tri[t*3+0]] + live[tri[t*3+1]] + live[tri[t*3+2]];
+        const auto     d    = center[t]-borderMid;
+        const float    dist = glm::dot(d,d);
+        if(best==NoTri || lv<bestLive || (lv==bestLive && dist<bestDist)) {
+          best     = t;
+          bestLive = lv;
+          bestDist = dist;
+          }
+        }
+      if(best!=NoTri)
+        return best;
+
+      while(cursor<triCount && used[cursor]!=0)
+        ++cursor;
+      return cursor<triCount ? uint32_t(cursor) : NoTri;
+      }
+
+    uint32_t pickAdjacent() {
+      auto& f0 = front[0];
+      while(!f0.empty()) {
+        // bounds are unchanged, no need to look further
+        const uint32_t t = f0.back();
+        f0.pop_back();
+        if(used[t]==0 && newVerts(t)==0)
+          return t;
+        }
+
+      const glm::vec3 mid = activeCenter();
+      for(uint32_t nv=1; nv<3; ++nv) {
+        auto&    f        = front[nv];
+        uint32_t best     = NoTri;
+        float    bestDist = 0;
+        size_t   sz       = 0;
+        for(size_t i=0; i<f.size(); ++i) {
+          const uint32_t t = f[i];
+          if(used[t]!=0 || newVerts(t)!=nv)
+            continue; // already in lower bucket
+          f[sz++] = t;
+          if(active.vertSz+nv>MaxVert)
+            continue;
+          const auto  d    = center[t]-mid;
+          const float dist = glm::dot(d,d);
+          if(best==NoTri || dist<bestDist) {
+            best     = t;
+            bestDist = dist;
+            }
+          }
+        f.resize(sz);
+        if(best!=NoTri)
+          return best;
+        }
+      return NoTri;
+      }
+
+    uint32_t pickNearby() const {
+      const glm::vec3 mid      = activeCenter();
+      const size_t    b        = last>SearchWindow ? last-SearchWindow : 0;
+      const size_t    e        = std::min(last+SearchWindow+1, triCount);
+      uint32_t        best     = NoTri;
+      float           bestDist = 0;
+      for(size_t i=b; i<e; ++i) {
+        const uint32_t t = uint32_t(i);
+        if(used[t]!=0 || active.vertSz+newVerts(t)>MaxVert)
+          continue;
+        const auto  d    = center[t]-mid;
+        const float dist = glm::dot(d,d);
+        if(best==NoTri || dist<bestDist) {
+          best     = t;
+          bestDist = dist;
+          }
+        }
+      return best;
+      }
+
+    void add(uint32_t t) {
+      used[t] = generation;
+
+      uint8_t ind[3] = {};
+      bool    isNew  = false;
+      for(int i=0; i<3; ++i) {
+        const uint32_t v = tri[t*3+i];
+        live[v]--;
+        if(slot[v]==NoSlot) {
+          slot[v]                    = active.vertSz;
+          activeVert [active.vertSz] = v;
+          active.vert[active.vertSz] = verts[v];
+          active.vertSz++;
+          isNew = true;
+
+          for(size_t r=adjOffset[v]; r<adjOffset[v+1]; ++r) {
+            const uint32_t at = adj[r];
+            if(used[at]!=0)
+              continue;
+            const uint32_t nv = newVerts(at);
+            if(nv<3)
+              front[nv].push_back(at);
+            }
+          }
+        ind[i] = slot[v];
+        }
+
+      if(!isNew && isDuplicate(t))
+        return;
+
+      std::memcpy(&active.indexes[active.indSz], ind, 3);
+      active.indSz = uint8_t(active.indSz+3u);
+      activeSum   += center[t];
+      last         = t;
+      }
+
+    bool isDuplicate(uint32_t t) const {
+      const uint32_t a = tri[t*3+0], b = tri[t*3+1], c = tri[t*3+2];
+      for(size_t r=adjOffset[a]; r<adjOffset[a+1]; ++r) {
+        const uint32_t at = adj[r];
+        if(at!=t && used[at]==generation && tri[at*3+0]==a && tri[at*3+1]==b && tri[at*3+2]==c)
+          return true;
+        }
+      return false;
+      }
+
+    void flush(std::vector<Meshlet>& out) {
+      for(size_t i=0; i<active.vertSz; ++i)
+        slot[activeVert[i]] = NoSlot;
+      if(active.indSz!=0) {
+        borderMid = activeCenter();
+        border.swap(front[1]);
+        border.insert(border.end(), front[2].begin(), front[2].end());
+        active.optimizeOrder();
+        active.updateBounds(vbo);
+        out.push_back(active);
+        }
+      active.clear();
+      activeSum = {};
+      for(auto& f:front)
+        f.clear();
+      ++generation;
       }
-    return std::make_pair(l,r);
-    }
   };
 
 void PackedMesh::Meshlet::flush(std::vector<Vertex>& vertices,
@@ -131,23 +402,21 @@ void PackedMesh::Meshlet::flush(std::vector<Vertex>& vertices,
     indices[iboSz+i] = uint32_t(vboSz+indSz/3);
     }
 
-  if(Gothic::options().doMeshShading || true) {
-    size_t iboSz8 = indices8.size();
-    indices8.resize(iboSz8 + MaxPrim*4);
-    for(size_t i=0; i<indSz; i+=3) {
-      size_t at = iboSz8 + (i/3)*4;
-      indices8[at+0] = indexes[i+0];
-      indices8[at+1] = indexes[i+1];
-      indices8[at+2] = indexes[i+2];
-      indices8[at+3] = 0;
-      }
-    if(indSz+1<MaxInd) {
-      size_t at = iboSz8 + MaxPrim*4 - 4;
-      indices8[at+0] = indexes[0];
-      indices8[at+1] = indexes[0];
-      indices8[at+2] = indSz/3;
-      indices8[at+3] = vertSz;
-      }
+  size_t iboSz8 = indices8.size();
+  indices8.resize(iboSz8 + MaxPrim*4);
+  for(size_t i=0; i<indSz; i+=3) {
+    size_t at = iboSz8 + (i/3)*4;
+    indices8[at+0] = indexes[i+0];
+    indices8[at+1] = indexes[i+1];
+    indices8[at+2] = indexes[i+2];
+    indices8[at+3] = 0;
+    }
+  if(indSz+1<MaxInd) {
+    size_t at = iboSz8 + MaxPrim*4 - 4;
+    indices8[at+0] = indexes[0];
+    indices8[at+1] = indexes[0];
+    indices8[at+2] = indSz/3;
+    indices8[at+3] = vertSz;
     }
   }
 
@@ -236,23 +505,21 @@ void PackedMesh::Meshlet::flush(std::vector<Vertex>& vertices, std::vector<Verte
     indices[iboSz+i] = uint32_t(vboSz+indSz/3);
     }
 
-  if(Gothic::options().doMeshShading || true) {
-    size_t iboSz8 = indices8.size();
-    indices8.resize(iboSz8 + MaxPrim*4);
-    for(size_t i=0; i<indSz; i+=3) {
-      size_t at = iboSz8 + (i/3)*4;
-      indices8[at+0] = indexes[i+0];
-      indices8[at+1] = indexes[i+1];
-      indices8[at+2] = indexes[i+2];
-      indices8[at+3] = 0;
-      }
-    if(indSz+1<MaxInd) {
-      size_t at = iboSz8 + MaxPrim*4 - 4;
-      indices8[at+0] = indexes[0];
-      indices8[at+1] = indexes[0];
-      indices8[at+2] = indSz/3;
-      indices8[at+3] = vertSz;
-      }
+  size_t iboSz8 = indices8.size();
+  indices8.resize(iboSz8 + MaxPrim*4);
+  for(size_t i=0; i<indSz; i+=3) {
+    size_t at = iboSz8 + (i/3)*4;
+    indices8[at+0] = indexes[i+0];
+    indices8[at+1] = indexes[i+1];
+    indices8[at+2] = indexes[i+2];
+    indices8[at+3] = 0;
+    }
+  if(indSz+1<MaxInd) {
+    size_t at = iboSz8 + MaxPrim*4 - 4;
+    indices8[at+0] = indexes[0];
+    indices8[at+1] = indexes[0];
+    indices8[at+2] = indSz/3;
+    indices8[at+3] = vertSz;
     }
   }
 
@@ -270,124 +537,160 @@ bool PackedMesh::Meshlet::validate() const {
   */
   }
 
-bool PackedMesh::Meshlet::insert(const Vert& a, const Vert& b, const Vert& c) {
-  if(indSz+3>MaxInd)
-    return false;
-
-  uint8_t ea = MaxVert, eb = MaxVert, ec = MaxVert;
-  for(uint8_t i=0; i<vertSz; ++i) {
-    if(vert[i]==a)
-      ea = i;
-    if(vert[i]==b)
-      eb = i;
-    if(vert[i]==c)
-      ec = i;
-    }
-
-  uint8_t vSz = vertSz;
-  if(ea==MaxVert) {
-    ea = vSz;
-    ++vSz;
-    }
-  if(eb==MaxVert) {
-    eb = vSz;
-    ++vSz;
-    }
-  if(ec==MaxVert) {
-    ec = vSz;
-    ++vSz;
-    }
-
-  if(vSz>MaxVert)
-    return false;
-
-  if(vSz==vertSz) {
-    for(size_t i=0; i<indSz; i+=3) {
-      if(indexes[i+0]==ea && indexes[i+1]==eb && indexes[i+2]==ec) {
-        // duplicant?
-        return true;
-        }
-      }
-    }
-
-  indexes[indSz+0] = ea;
-  indexes[indSz+1] = eb;
-  indexes[indSz+2] = ec;
-  indSz            = uint8_t(indSz+3u);
-
-  vert[ea] = a;
-  vert[eb] = b;
-  vert[ec] = c;
-  vertSz   = vSz;
-
-  return true;
-  }
-
 void PackedMesh::Meshlet::clear() {
   vertSz = 0;
   indSz  = 0;
   }
 
-void PackedMesh::Meshlet::updateBounds(const zenkit::Mesh& mesh) {
-  updateBounds(mesh.vertices);
+void PackedMesh::Meshlet::optimizeOrder() {
+  // tipsify (Sander et al.) for post-transform vertex cache, then vertices in order of first use
+  static constexpr uint32_t CacheSize = 16;
+  static constexpr uint8_t  NoVert    = 0xFF;
+
+  uint8_t adjOffset[MaxVert+1] = {};
+  uint8_t adj[MaxInd]          = {};
+  for(size_t i=0; i<indSz; ++i)
+    adjOffset[indexes[i]+1]++;
+  for(size_t i=1; i<=vertSz; ++i)
+    adjOffset[i] = uint8_t(adjOffset[i]+adjOffset[i-1]);
+  uint8_t live[MaxVert] = {};
+  for(size_t i=0; i<vertSz; ++i)
+    live[i] = uint8_t(adjOffset[i+1]-adjOffset[i]);
+  {
+  uint8_t at[MaxVert] = {};
+  std::memcpy(at, adjOffset, vertSz);
+  for(size_t i=0; i<indSz; ++i)
+    adj[at[indexes[i]]++] = uint8_t(i/3);
   }
 
-void PackedMesh::Meshlet::updateBounds(const zenkit::MultiResolutionMesh& mesh) {
-  updateBounds(mesh.positions);
+  uint8_t src[MaxInd];
+  std::memcpy(src, indexes, indSz);
+
+  uint32_t stamp[MaxVert] = {};
+  bool     done [MaxPrim] = {};
+  uint8_t  deadEnd[MaxInd];
+  size_t   deadEndSz = 0;
+  uint32_t time      = CacheSize+1;
+  uint8_t  cursor    = 1;
+  size_t   out       = 0;
+
+  uint8_t  fan = 0;
+  while(fan!=NoVert) {
+    uint8_t cand[MaxInd];
+    size_t  candSz = 0;
+    for(size_t r=adjOffset[fan]; r<adjOffset[fan+1]; ++r) {
+      const uint8_t p = adj[r];
+      if(done[p])
+        continue;
+      done[p] = true;
+      for(int i=0; i<3; ++i) {
+        const uint8_t v = src[p*3+i];
+        indexes[out++]       = v;
+        deadEnd[deadEndSz++] = v;
+        cand[candSz++]       = v;
+        live[v]--;
+        if(time-stamp[v]>CacheSize)
+          stamp[v] = time++;
+        }
+      }
+
+    // next fanning vertex: the oldest one, that is still in cache after emitting its triangles
+    fan = NoVert;
+    uint32_t best = 0;
+    for(size_t i=0; i<candSz; ++i) {
+      const uint8_t v = cand[i];
+      if(live[v]==0)
+        continue;
+      const uint32_t age = time-stamp[v];
+      if(age+2u*live[v]<=CacheSize && (fan==NoVert || age>best)) {
+        fan  = v;
+        best = age;
+        }
+      }
+    while(fan==NoVert && deadEndSz>0) {
+      const uint8_t v = deadEnd[--deadEndSz];
+      if(live[v]>0)
+        fan = v;
+      }
+    while(fan==NoVert && cursor<vertSz) {
+      if(live[cursor]>0)
+        fan = cursor;
+      ++cursor;
+      }
+    }
+
+  uint8_t remap[MaxVert];
+  std::memset(remap, NoVert, sizeof(remap));
+  Vert    vsrc[MaxVert];
+  std::copy(vert, vert+vertSz, vsrc);
+  uint8_t vSz = 0;
+  for(size_t i=0; i<indSz; ++i) {
+    auto& v = indexes[i];
+    if(remap[v]==NoVert) {
+      remap[v]  = vSz;
+      vert[vSz] = vsrc[v];
+      ++vSz;
+      }
+    v = remap[v];
+    }
   }
 
 void PackedMesh::Meshlet::updateBounds(const std::vector<glm::vec3>& vbo) {
-  float dim = 0;
-  for(size_t i=0; i<vertSz; ++i)
-    for(size_t r=i+1; r<vertSz; ++r) {
-      auto a = vbo[vert[i].first];
-      auto b = vbo[vert[r].first];
-      a.x -= b.x;
-      a.y -= b.y;
-      a.z -= b.z;
-      float d = a.x*a.x + a.y*a.y + a.z*a.z;
+  // Ritter's sphere, seeded with approximate diameter; sphere around aabb center if it's tighter
+  if(vertSz==0) {
+    bounds = Cluster();
+    return;
+    }
+
+  auto at = [&](size_t i) {
+    auto& v = vbo[vert[i].first];
+    return Vec3(v.x,v.y,v.z);
+    };
+  auto farthest = [&](const Vec3& from) {
+    size_t ret = 0;
+    float  dim = -1;
+    for(size_t i=0; i<vertSz; ++i) {
+      float d = (at(i)-from).quadLength();
       if(dim<d) {
-        bounds.pos = Vec3(b.x,b.y,b.z)+Vec3(a.x,a.y,a.z)*0.5f;
         dim = d;
+        ret = i;
         }
       }
-  bounds.r = 0;
+    return at(ret);
+    };
+  auto radius = [&](const Vec3& pos) {
+    float r = 0;
+    for(size_t i=0; i<vertSz; ++i)
+      r = std::max(r, (at(i)-pos).quadLength());
+    return std::sqrt(r);
+    };
+
+  const Vec3 a = farthest(at(0));
+  const Vec3 b = farthest(a);
+  Vec3  pos = (a+b)*0.5f;
+  float r   = (b-a).length()*0.5f;
   for(size_t i=0; i<vertSz; ++i) {
-    auto a = vbo[vert[i].first];
-    a.x -= bounds.pos.x;
-    a.y -= bounds.pos.y;
-    a.z -= bounds.pos.z;
-    float d = (a.x*a.x + a.y*a.y + a.z*a.z);
-    if(bounds.r<d)
-      bounds.r = d;
-    }
-  bounds.r = std::sqrt(bounds.r);
-  }
-
-bool PackedMesh::Meshlet::canMerge(const Meshlet& other) const {
-  if(vertSz+other.vertSz>MaxVert)
-    return false;
-  if(indSz+other.indSz>MaxInd)
-    return false;
-  return true;
-  }
-
-bool PackedMesh::Meshlet::hasIntersection(const Meshlet& other) const {
-  return (bounds.pos-other.bounds.pos).quadLength() < std::pow(bounds.r+other.bounds.r,2.f);
-  }
-
-float PackedMesh::Meshlet::qDistance(const Meshlet& other) const {
-  return (bounds.pos-other.bounds.pos).quadLength();
-  }
+    const Vec3  v = at(i);
+    const float d = (v-pos).length();
+    if(d<=r)
+      continue;
+    const float nr = (r+d)*0.5f;
+    pos = pos + (v-pos)*((nr-r)/d);
+    r   = nr;
+    }
 
-void PackedMesh::Meshlet::merge(const Meshlet& other) {
-  for(uint8_t i=0; i<other.indSz; ++i) {
-    uint8_t index  = uint8_t(vertSz+other.indexes[i]);
-    indexes[indSz] = index;
-    vert[index]    = other.vert[other.indexes[i]];
-    ++indSz;
+  Vec3 bmin = at(0), bmax = at(0);
+  for(size_t i=1; i<vertSz; ++i) {
+    const Vec3 v = at(i);
+    bmin = Vec3(std::min(bmin.x,v.x), std::min(bmin.y,v.y), std::min(bmin.z,v.z));
+    bmax = Vec3(std::max(bmax.x,v.x), std::max(bmax.y,v.y), std::max(bmax.z,v.z));
     }
-  vertSz = uint8_t(vertSz+other.vertSz);
+  const Vec3 boxPos = (bmin+bmax)*0.5f;
+
+  const float r0 = radius(pos);
+  const float r1 = radius(boxPos);
+  bounds.pos = (r0<=r1) ? pos : boxPos;
+  bounds.r   = std::min(r0,r1);
   }
 
 PackedMesh::PackedMesh(const zenkit::Mesh& mesh, PkgType type) {
@@ -516,6 +819,17 @@ void PackedMesh::packPhysics(const zenkit::Mesh& mesh, PkgType type) {
     }
   }
 
+template<class F>
+void PackedMesh::packGroups(size_t count, size_t triCount, const F& func) {
+  // small meshes are packed inline: they are loaded from worker threads anyway
+  if(triCount<ParallelMinTri) {
+    for(size_t i=0; i<count; ++i)
+      func(i);
+    return;
+    }
+  Workers::parallelTasks(count,func);
+  }
+
 void PackedMesh::packMeshletsLnd(const zenkit::Mesh& mesh) {
   auto& ibo  = mesh.polygons.vertex_indices;
   auto& feat = mesh.polygons.feature_indices;
@@ -548,47 +862,45 @@ void PackedMesh::packMeshletsLnd(const zenkit::Mesh& mesh) {
     return std::tie(a.mat) < std::tie(b.mat);
     });
 
-  PrimitiveHeap heap;
-  heap.reserve(mid.size());
-  std::vector<bool> used(mid.size(),false);
-
-  vertices.reserve(mesh.vertices.size());
-  indices .reserve(ibo.size());
-  indices8.reserve(ibo.size());
-  meshletBounds.reserve(prim.size()/MaxPrim);
+  struct Group {
+    uint32_t             mat = 0;
+    std::vector<Vert>    tri;
+    std::vector<Meshlet> meshlets;
+    };
+  std::vector<Group> groups;
   for(size_t i=0; i<prim.size();) {
-    const auto mId = prim[i].mat;
-
-    heap.clear();
-    for(; i<prim.size() && prim[i].mat==mId; ++i) {
+    Group g;
+    g.mat = prim[i].mat;
+    for(; i<prim.size() && prim[i].mat==g.mat; ++i) {
       const uint32_t id = prim[i].primId;
-
-      auto a = mkUInt64(ibo[id+0],feat[id+0]);
-      auto b = mkUInt64(ibo[id+1],feat[id+1]);
-      auto c = mkUInt64(ibo[id+2],feat[id+2]);
-
-      heap.push_back(std::make_pair(a, id));
-      heap.push_back(std::make_pair(b, id));
-      heap.push_back(std::make_pair(c, id));
+      for(uint32_t r=0; r<3; ++r)
+        g.tri.emplace_back(ibo[id+r],feat[id+r]);
       }
+    groups.push_back(std::move(g));
+    }
 
-    if(heap.size()==0)
-      continue;
-
-    std::vector<Meshlet> meshlets = buildMeshlets(&mesh,nullptr,heap,used);
-    for(size_t i=0; i<meshlets.size(); ++i)
-      meshlets[i].updateBounds(mesh);
+  packGroups(groups.size(), prim.size(), [&](size_t id) {
+    auto& g = groups[id];
+    g.meshlets = buildMeshlets(mesh.vertices,g.tri);
+    g.tri      = std::vector<Vert>();
+    });
 
+  vertices.reserve(mesh.vertices.size());
+  indices .reserve(ibo.size());
+  indices8.reserve(ibo.size());
+  meshletBounds.reserve(prim.size()/MaxPrim);
+  for(auto& g:groups) {
     SubMesh pack;
-    pack.material  = mesh.materials[mId];
-    pack.iboOffset = indices.size();
-    for(auto& i:meshlets)
+    pack.material   = mesh.materials[g.mat];
+    pack.materialId = g.mat;
+    pack.iboOffset  = indices.size();
+    for(auto& i:g.meshlets)
       i.flush(vertices,indices,indices8,meshletBounds,mesh);
     pack.iboLength = indices.size() - pack.iboOffset;
     if(pack.iboLength>0)
       subMeshes.push_back(std::move(pack));
 
-    //dbgUtilization(meshlets);
+    //dbgUtilization(g.meshlets);
     }
   }
 
@@ -596,130 +908,41 @@ void PackedMesh::packMeshletsObj(const zenkit::MultiResolutionMesh& mesh, PkgTyp
                                  const std::vector<SkeletalData>* skeletal) {
   auto* vId = (type==PK_VisualMorph) ? &verticesId : nullptr;
 
-  size_t maxTri = 0;
+  size_t triCount = 0;
   for(auto& sm:mesh.sub_meshes)
-    maxTri = std::max(maxTri, sm.triangles.size());
-  PrimitiveHeap heap;
-  heap.reserve(maxTri);
-  std::vector<bool> used(maxTri);
+    triCount += sm.triangles.size();
 
-  for(size_t mId=0; mId<mesh.sub_meshes.size(); ++mId) {
-    auto& sm      = mesh.sub_meshes[mId];
-    auto& pack    = subMeshes[mId];
-    pack.material = sm.mat;
-
-    heap.clear();
+  std::vector<std::vector<Meshlet>> meshlets(mesh.sub_meshes.size());
+  packGroups(mesh.sub_meshes.size(), triCount, [&](size_t mId) {
+    auto& sm = mesh.sub_meshes[mId];
+    std::vector<Vert> tri(sm.triangles.size()*3);
     for(size_t i=0; i<sm.triangles.size(); ++i) {
       const uint16_t* ibo = sm.triangles[i].wedges;
-      for(int x=0; x<3; ++x) {
-        auto& wedge = sm.wedges[ibo[x]];
-        auto vert = mkUInt64(wedge.index,ibo[x]);
-        heap.push_back(std::make_pair(vert,uint32_t(i*3)));
-        }
+      for(int x=0; x<3; ++x)
+        tri[i*3+size_t(x)] = std::make_pair(sm.wedges[ibo[x]].index, uint32_t(ibo[x]));
       }
+    meshlets[mId] = buildMeshlets(mesh.positions,tri);
+    });
 
-    std::vector<Meshlet> meshlets = buildMeshlets(nullptr,&sm,heap,used);
-    for(size_t i=0; i<meshlets.size(); ++i)
-      meshlets[i].updateBounds(mesh);
+  for(size_t mId=0; mId<mesh.sub_meshes.size(); ++mId) {
+    auto& sm      = mesh.sub_meshes[mId];
+    auto& pack    = subMeshes[mId];
+    pack.material = sm.mat;
 
     pack.iboOffset = indices.size();
-    for(auto& i:meshlets)
+    for(auto& i:meshlets[mId])
       i.flush(vertices,verticesA,indices,indices8,vId,mesh.positions,sm.wedges,skeletal);
     pack.iboLength = indices.size() - pack.iboOffset;
 
-    //dbgUtilization(meshlets);
+    //dbgUtilization(meshlets[mId]);
     }
   }
 
-std::vector<PackedMesh::Meshlet> PackedMesh::buildMeshlets(const zenkit::Mesh* mesh,
-                                                           const zenkit::SubMesh* proto_mesh,
-                                                           PrimitiveHeap& heap, std::vector<bool>& used) {
-  heap.sort();
-  std::fill(used.begin(), used.end(), false);
-
-  const bool tightPacking = true;
-
-  size_t  firstUnused = 0;
-  size_t  firstVert   = 0;
-  Meshlet active;
-
-  std::vector<Meshlet> meshlets;
-  while(true) {
-    size_t triId = size_t(-1);
-
-    for(size_t r=firstVert; r<active.vertSz; ++r) {
-      auto i = active.vert[r];
-      auto e = heap.equal_range(mkUInt64(i.first,i.second));
-      for(auto it = e.first; it!=e.second; ++it) {
-        auto id = it->second/3;
-        if(used[id])
-          continue;
-        if(addTriangle(active,mesh,proto_mesh,id)) {
-          used[id] = true;
-          continue;
-          }
-        triId = id;
-        break;
-        }
-      firstVert = r+1;
-      }
-
-    if(triId==size_t(-1) && active.indSz!=0 && !tightPacking) {
-      // active.validate();
-      meshlets.push_back(std::move(active));
-      active.clear();
-      firstVert = 0;
-      continue;
-      }
-
-    if(triId==size_t(-1)) {
-      for(auto i=heap.begin()+ptrdiff_t(firstUnused); i!=heap.end();) {
-        if(used[i->second/3]) {
-          ++i;
-          continue;
-          }
-        firstUnused = size_t(std::distance(heap.begin(),i+1));
-        triId       = i->second/3;
-        break;
-        }
-      }
-
-    if(triId!=size_t(-1) && addTriangle(active,mesh,proto_mesh,triId)) {
-      used[triId] = true;
-      continue;
-      }
-
-    if(active.indSz!=0) {
-      // active.validate();
-      meshlets.push_back(std::move(active));
-      active.clear();
-      firstVert = 0;
-      }
-
-    if(triId==size_t(-1))
-      break;
-    }
-
-  return meshlets;
-  }
-
-bool PackedMesh::addTriangle(Meshlet& dest, const zenkit::Mesh* mesh, const zenkit::SubMesh* sm, size_t id) {
-  if(mesh!=nullptr) {
-    size_t id3  = id*3;
-    auto&  ibo  = mesh->polygons.vertex_indices;
-    auto&  feat = mesh->polygons.feature_indices;
-
-    auto a = std::make_pair(ibo[id3+0],feat[id3+0]);
-    auto b = std::make_pair(ibo[id3+1],feat[id3+1]);
-    auto c = std::make_pair(ibo[id3+2],feat[id3+2]);
-    return dest.insert(a,b,c);
-    }
-
-  const uint16_t* feat = sm->triangles[id].wedges;
-  auto a = std::make_pair(sm->wedges[feat[0]].index, feat[0]);
-  auto b = std::make_pair(sm->wedges[feat[1]].index, feat[1]);
-  auto c = std::make_pair(sm->wedges[feat[2]].index, feat[2]);
-  return dest.insert(a,b,c);
+std::vector<PackedMesh::Meshlet> PackedMesh::buildMeshlets(const std::vector<glm::vec3>& vbo, const std::vector<Vert>& tri) {
+  if(tri.empty())
+    return {};
+  MeshletBuilder builder(vbo,tri);
+  return builder.build();
   }
 
 void PackedMesh::debug(std::ostream &out) const {
@@ -33,8 +33,9 @@ class PackedMesh {
 
     struct SubMesh final {
       zenkit::Material material;
-      size_t           iboOffset = 0;
-      size_t           iboLength = 0;
+      uint32_t         materialId = 0; // index in source material list; only for landscape
+      size_t           iboOffset  = 0;
+      size_t           iboLength  = 0;
       };
 
     struct Cluster final {
@@ -53,6 +54,7 @@ class PackedMesh {
     std::vector<uint32_t> verticesId; // only for morph meshes
     bool                  isUsingAlphaTest = true;
 
+    PackedMesh() = default;
     PackedMesh(const zenkit::MultiResolutionMesh& mesh, PkgType type);
     PackedMesh(const zenkit::Mesh& mesh, PkgType type);
     PackedMesh(const zenkit::SoftSkinMesh& mesh);
@@ -62,6 +64,8 @@ class PackedMesh {
     std::pair<Tempest::Vec3,Tempest::Vec3> bbox() const;
 
   private:
+    static constexpr size_t ParallelMinTri = 4096;
+
     Tempest::Vec3 mBbox[2];
 
     struct Prim {
@@ -76,7 +80,7 @@ class PackedMesh {
       };
 
     using  Vert = std::pair<uint32_t,uint32_t>;
-    struct PrimitiveHeap;
+    struct MeshletBuilder;
     struct Meshlet {
       Vert          vert   [MaxVert] = {};
       uint8_t       indexes[MaxInd ] = {};
@@ -95,30 +99,25 @@ class PackedMesh {
                     const std::vector<SkeletalData>* skeletal);
       bool    validate() const;
 
-      bool    insert(const Vert& a, const Vert& b, const Vert& c);
       void    clear();
-      void    updateBounds(const zenkit::Mesh& mesh);
-      void    updateBounds(const zenkit::MultiResolutionMesh& mesh);
+      void    optimizeOrder();
       void    updateBounds(const std::vector<glm::vec3>& vbo);
-      bool    canMerge(const Meshlet& other) const;
-      bool    hasIntersection(const Meshlet& other) const;
-      float   qDistance(const Meshlet& other) const;
-      void    merge(const Meshlet& other);
       };
 
-    bool   addTriangle(Meshlet& dest, const zenkit::Mesh* mesh, const zenkit::SubMesh* proto_mesh, size_t id);
-
     void   packPhysics(const zenkit::Mesh& mesh, PkgType type);
     void   packMeshletsLnd(const zenkit::Mesh& mesh);
     void   packMeshletsObj(const zenkit::MultiResolutionMesh& mesh, PkgType type,
                            const std::vector<SkeletalData>* skeletal);
 
-    std::vector<Meshlet> buildMeshlets(const zenkit::Mesh* mesh, const zenkit::SubMesh* proto_mesh,
-                                       PrimitiveHeap& heap, std::vector<bool>& used);
+    template<class F>
+    static void packGroups(size_t count, size_t triCount, const F& func);
+    static std::vector<Meshlet> buildMeshlets(const std::vector<glm::vec3>& vbo, const std::vector<Vert>& tri);
 
     void   computeBbox();
 
     void   dbgUtilization(const std::vector<Meshlet>& meshlets);
     void   dbgMeshlets(const zenkit::Mesh& mesh, const std::vector<Meshlet*>& meshlets);
+
+  friend class LandscapeCache;
   };
 
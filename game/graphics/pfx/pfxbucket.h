@@ -17,6 +17,8 @@ class PfxBucket {
     PfxBucket(const ParticleFx &decl, PfxObjects& parent, const SceneGlobals& scene, VisualObjects& visual);
     ~PfxBucket();
 
+    static void seed(uint32_t s) { rndEngine.seed(s); }
+
     enum AllocState: uint8_t {
       S_Free,
       S_Fade,
@@ -4,6 +4,7 @@
 #include <cstring>
 
 #include "graphics/sceneglobals.h"
+#include "utils/profiler.h"
 
 #include "pfxbucket.h"
 #include "particlefx.h"
@@ -26,6 +27,7 @@ void PfxObjects::resetTicks() {
   }
 
 void PfxObjects::tick(uint64_t ticks) {
+  Profiler::Zone zone("PfxObjects::tick");
   static bool disabled = false;
   if(disabled)
     return;
@@ -59,6 +61,7 @@ void PfxObjects::prepareUniforms() {
   }
 
 void PfxObjects::preFrameUpdate(uint8_t fId) {
+  Profiler::Zone zone("PfxObjects::preFrameUpdate");
   for(auto i=bucket.begin(), end = bucket.end(); i!=end; ) {
     if(i->isEmpty()) {
       i = bucket.erase(i);
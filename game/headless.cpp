@@ -0,0 +1,175 @@
+#include "headless.h"
+
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "game/serialize.h"
+#include "world/objects/npc.h"
+#include "utils/mappedfile.h"
+#include "commandline.h"
+#include "camera.h"
+#include "gothic.h"
+#include "resources.h"
+
+using namespace Tempest;
+
+static uint64_t elapsedUs(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+  return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(b-a).count());
+  }
+
+Headless::Headless() {
+  Gothic::inst().onSessionExit.bind(this,&Headless::onSessionExit);
+  }
+
+Headless::~Headless() {
+  Gothic::inst().onSessionExit.ubind(this,&Headless::onSessionExit);
+  Gothic::inst().cancelLoading();
+  Gothic::inst().setGame(std::unique_ptr<GameSession>());
+  }
+
+int Headless::exec() {
+  startGame();
+  if(!waitLoading())
+    return 1;
+
+  const uint64_t dt     = CommandLine::inst().timestep();
+  const uint64_t length = CommandLine::inst().headlessTime();
+  Log::i("headless: simulating ",length/1000," s, timestep ",dt," ms");
+
+  auto    wall0 = std::chrono::steady_clock::now();
+  uint8_t fId   = 0;
+  while(simTime<length && !exitFlg) {
+    if(Gothic::inst().checkLoading()!=Gothic::LoadState::Idle) {
+      // world change
+      if(!waitLoading())
+        return 1;
+      continue;
+      }
+    tick(dt);
+    // no frames in flight: resources, released by simulation, can be freed right away
+    Resources::resetRecycled(fId);
+    fId = uint8_t((fId+1u)%Resources::MaxFramesInFlight);
+    }
+  auto wall1 = std::chrono::steady_clock::now();
+
+  report(std::chrono::duration<double>(wall1-wall0).count());
+  return 0;
+  }
+
+void Headless::startGame() {
+  auto& gothic = Gothic::inst();
+  if(!gothic.defaultSave().empty()) {
+    gothic.startLoad("LOADING.TGA",[slot=std::string(gothic.defaultSave())](std::unique_ptr<GameSession>&& game){
+      game = nullptr;
+      MappedFile file(slot);
+      Serialize  s(file.data(),file.size());
+      return std::unique_ptr<GameSession>(new GameSession(s));
+      });
+    return;
+    }
+  gothic.startLoad("LOADING.TGA",[slot=std::string(gothic.defaultWorld())](std::unique_ptr<GameSession>&& game){
+    game = nullptr;
+    return std::unique_ptr<GameSession>(new GameSession(slot));
+    });
+  }
+
+bool Headless::waitLoading() {
+  auto& gothic = Gothic::inst();
+  while(true) {
+    const auto st = gothic.checkLoading();
+    if(st==Gothic::LoadState::Idle) {
+      // no swapchain: animation LOD is selected against fixed full-hd view
+      if(auto camera = gothic.camera())
+        camera->setViewport(ViewportW,ViewportH);
+      return gothic.gameSession()!=nullptr;
+      }
+    if(st==Gothic::LoadState::Finalize || st==Gothic::LoadState::FailedLoad || st==Gothic::LoadState::FailedSave) {
+      gothic.finishLoading();
+      if(st==Gothic::LoadState::FailedLoad) {
+        Log::e("headless: unable to load game");
+        return false;
+        }
+      continue;
+      }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+void Headless::tickCamera(uint64_t dt) {
+  // same as MainWindow::tickCamera, without input: camera follows the player
+  auto& gothic = Gothic::inst();
+  auto  camera = gothic.camera();
+  auto  pl     = gothic.player();
+  if(camera==nullptr || pl==nullptr)
+    return;
+
+  if(!camera->isCutscene()) {
+    auto spin = camera->destSpin();
+    if(pl->interactive()==nullptr && !pl->isDown())
+      spin.y = pl->rotation();
+    camera->setDestSpin(spin);
+    camera->setDestPosition(pl->cameraBone(camera->isFirstPerson()));
+    }
+  camera->tick(dt);
+  }
+
+void Headless::tick(uint64_t dt) {
+  auto& gothic = Gothic::inst();
+  tickCamera(dt);
+  auto  t0     = std::chrono::steady_clock::now();
+  gothic.tick(dt);
+  auto  t1     = std::chrono::steady_clock::now();
+  gothic.updateAnimation(dt);
+  auto  t2     = std::chrono::steady_clock::now();
+
+  World::TickTimings wt;
+  if(auto w = gothic.world())
+    wt = w->takeTickTimings();
+
+  const uint64_t world   = wt.objects + wt.physics + wt.view + wt.sound + wt.effects;
+  const uint64_t session = elapsedUs(t0,t1);
+
+  uint64_t v[S_Count] = {};
+  v[S_Session]   = session>world ? session-world : 0;
+  v[S_Objects]   = wt.objects;
+  v[S_Physics]   = wt.physics;
+  v[S_View]      = wt.view;
+  v[S_Sound]     = wt.sound;
+  v[S_Effects]   = wt.effects;
+  v[S_Animation] = elapsedUs(t1,t2);
+  v[S_Total]     = elapsedUs(t0,t2);
+  for(size_t i=0; i<S_Count; ++i) {
+    stat[i].sum += v[i];
+    stat[i].max  = std::max(stat[i].max,v[i]);
+    }
+
+  ticks++;
+  simTime += dt;
+  }
+
+void Headless::report(double wallTime) const {
+  static const char* name[S_Count] = {"session", "objects", "physics", "view", "sound", "effects", "animation", "total"};
+
+  const double sim = double(simTime)/1000.0;
+  const auto*  w   = Gothic::inst().world();
+  std::printf("headless: %llu ticks, %.1f s simulated in %.1f s (%.2fx realtime), npc: %u\n",
+              static_cast<unsigned long long>(ticks), sim, wallTime, wallTime>0 ? sim/wallTime : 0.0,
+              w!=nullptr ? w->npcCount() : 0u);
+  std::printf("  %-10s %10s %10s %10s %7s\n", "stage", "total ms", "avg us", "max us", "share");
+  for(size_t i=0; i<S_Count; ++i) {
+    const double total = double(stat[i].sum)/1000.0;
+    const double avg   = ticks>0 ? double(stat[i].sum)/double(ticks) : 0.0;
+    const double share = stat[S_Total].sum>0 ? double(stat[i].sum)*100.0/double(stat[S_Total].sum) : 0.0;
+    std::printf("  %-10s %10.1f %10.1f %10llu %6.1f%%\n", name[i], total, avg,
+                static_cast<unsigned long long>(stat[i].max), share);
+    }
+  std::fflush(stdout);
+  }
+
+void Headless::onSessionExit() {
+  exitFlg = true;
+  }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// game simulation without window, swapchain and renderer:
+// ticks session and animation on fixed timestep and reports time spent per subsystem
+class Headless final {
+  public:
+    Headless();
+    ~Headless();
+
+    int  exec();
+
+  private:
+    enum Stage : uint8_t {
+      S_Session,
+      S_Objects,
+      S_Physics,
+      S_View,
+      S_Sound,
+      S_Effects,
+      S_Animation,
+      S_Total,
+      S_Count
+      };
+
+    static constexpr uint32_t ViewportW = 1920;
+    static constexpr uint32_t ViewportH = 1080;
+
+    struct Stat final {
+      uint64_t sum = 0; // microseconds
+      uint64_t max = 0;
+      };
+
+    void startGame();
+    bool waitLoading();
+    void tickCamera(uint64_t dt);
+    void tick(uint64_t dt);
+    void report(double wallTime) const;
+    void onSessionExit();
+
+    Stat     stat[S_Count];
+    uint64_t ticks   = 0;
+    uint64_t simTime = 0;
+    bool     exitFlg = false;
+  };
@@ -20,6 +20,7 @@
 
 #include "utils/crashlog.h"
 #include "mainwindow.h"
+#include "headless.h"
 #include "gothic.h"
 #include "build.h"
 #include "commandline.h"
@@ -140,6 +141,12 @@ int main(int argc,const char** argv) {
   GameMusic            music;
   gothic.setupGlobalScripts();
 
+  if(cmd.isHeadless()) {
+    // device is still needed for resource upload; on machines without gpu use software vulkan driver
+    Headless headless;
+    return headless.exec();
+    }
+
   MainWindow           wx(device);
   Tempest::Application app;
   return app.exec();
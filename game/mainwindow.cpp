@@ -15,7 +15,9 @@
 #include "ui/videowidget.h"
 
 #include "utils/mouseutil.h"
+#include "utils/mappedfile.h"
 #include "utils/string_frm.h"
+#include "utils/profiler.h"
 #include "world/objects/npc.h"
 #include "game/serialize.h"
 #include "game/globaleffects.h"
@@ -73,7 +75,14 @@ MainWindow::MainWindow(Device& device)
 
   Gothic::inst().onVideo       .bind(this,&MainWindow::onVideo);
 
-  if(!Gothic::inst().defaultSave().empty()){
+  if(replay.isPlaying()) {
+    // trace defines session to start with
+    if(replay.startIsSave())
+      Gothic::inst().load(replay.startSlot()); else
+      startGame(replay.startSlot());
+    rootMenu.popMenu();
+    }
+  else if(!Gothic::inst().defaultSave().empty()){
     Gothic::inst().load(Gothic::inst().defaultSave());
     rootMenu.popMenu();
     }
@@ -264,6 +273,18 @@ void MainWindow::paintEvent(PaintEvent& event) {
     fnt.drawText(p,5,fnt.pixelSize()+5,fpsT);
     }
 
+  if(Profiler::isEnabled() && !Gothic::inst().isDesktop()) {
+    auto& fnt = Resources::font();
+    int   y   = 2*(fnt.pixelSize()+5);
+    char  line[128] = {};
+    for(auto& i:Profiler::stats()) {
+      std::snprintf(line,sizeof(line),"%.*s: min = %.2f, avg = %.2f, p99 = %.2f ms",
+                    int(i.name.size()),i.name.data(),i.min,i.avg,i.p99);
+      fnt.drawText(p,5,y,line);
+      y += fnt.pixelSize()+2;
+      }
+    }
+
   if(Gothic::inst().doClock() && world!=nullptr) {
     if (!Gothic::inst().isDesktop()) {
       auto hour = world->time().hour();
@@ -297,11 +318,11 @@ void MainWindow::resizeEvent(SizeEvent&) {
 void MainWindow::mouseDownEvent(MouseEvent &event) {
   if(event.button<sizeof(mouseP))
     mouseP[event.button]=true;
-  player.onKeyPressed(keycodec.tr(event),KeyEvent::K_NoKey);
+  playerKeyPressed(keycodec.tr(event),KeyEvent::K_NoKey);
   }
 
 void MainWindow::mouseUpEvent(MouseEvent &event) {
-  player.onKeyReleased(keycodec.tr(event));
+  playerKeyReleased(keycodec.tr(event));
   if(event.button<sizeof(mouseP))
     mouseP[event.button]=false;
   }
@@ -351,13 +372,88 @@ void MainWindow::tickMouse() {
   if(camLookaroundInverse)
     dpScaled.y *= -1.f;
 
-  camera->onRotateMouse(PointF(dpScaled.y,-dpScaled.x));
+  playerRotate(PointF(dpScaled.y,-dpScaled.x),-dpScaled.x,-dpScaled.y);
+  dMouse = Point();
+  }
+
+void MainWindow::playerKeyPressed(KeyCodec::Action a, Event::KeyType key, KeyCodec::Mapping mapping) {
+  if(replay.isPlaying())
+    return;
+  Replay::Event e;
+  e.type    = Replay::E_KeyPressed;
+  e.action  = uint8_t(a);
+  e.mapping = uint8_t(mapping);
+  e.key     = uint16_t(key);
+  replay.push(e);
+  player.onKeyPressed(a,key,mapping);
+  }
+
+void MainWindow::playerKeyReleased(KeyCodec::Action a, KeyCodec::Mapping mapping) {
+  if(replay.isPlaying())
+    return;
+  Replay::Event e;
+  e.type    = Replay::E_KeyReleased;
+  e.action  = uint8_t(a);
+  e.mapping = uint8_t(mapping);
+  replay.push(e);
+  player.onKeyReleased(a,mapping);
+  }
+
+void MainWindow::playerClearInput() {
+  if(replay.isPlaying())
+    return;
+  Replay::Event e;
+  e.type = Replay::E_ClearInput;
+  replay.push(e);
+  player.clearInput();
+  }
+
+void MainWindow::playerRotate(PointF cam, float dx, float dy) {
+  if(replay.isPlaying())
+    return;
+  Replay::Event e;
+  e.type = Replay::E_Camera;
+  e.x    = cam.x;
+  e.y    = cam.y;
+  replay.push(e);
+  if(auto camera = Gothic::inst().camera())
+    camera->onRotateMouse(cam);
+
   if(!inventory.isActive()) {
-    player.onRotateMouse  (-dpScaled.x);
-    player.onRotateMouseDy(-dpScaled.y);
+    e.type = Replay::E_Rotate;
+    e.x    = dx;
+    e.y    = dy;
+    replay.push(e);
+    player.onRotateMouse  (dx);
+    player.onRotateMouseDy(dy);
     }
+  }
 
-  dMouse = Point();
+void MainWindow::applyReplay(const Replay::Frame& f, bool postTick) {
+  const size_t begin = f.begin + (postTick ? f.pre : 0);
+  const size_t end   = begin   + (postTick ? f.post : f.pre);
+  for(size_t i=begin; i<end; ++i) {
+    auto& e = replay.event(i);
+    switch(e.type) {
+      case Replay::E_KeyPressed:
+        player.onKeyPressed(KeyCodec::Action(e.action),Event::KeyType(e.key),KeyCodec::Mapping(e.mapping));
+        break;
+      case Replay::E_KeyReleased:
+        player.onKeyReleased(KeyCodec::Action(e.action),KeyCodec::Mapping(e.mapping));
+        break;
+      case Replay::E_ClearInput:
+        player.clearInput();
+        break;
+      case Replay::E_Rotate:
+        player.onRotateMouse  (e.x);
+        player.onRotateMouseDy(e.y);
+        break;
+      case Replay::E_Camera:
+        if(auto camera = Gothic::inst().camera())
+          camera->onRotateMouse(PointF(e.x,e.y));
+        break;
+      }
+    }
   }
 
 void MainWindow::onSettings() {
@@ -430,7 +526,7 @@ void MainWindow::keyDownEvent(KeyEvent &event) {
 
   auto act = keycodec.tr(event);
   auto mapping = keycodec.mapping(event);
-  player.onKeyPressed(act,event.key,mapping);
+  playerKeyPressed(act,event.key,mapping);
 
   if(event.key==Event::K_F11) {
     auto tex = renderer.screenshoot(cmdId);
@@ -528,7 +624,7 @@ void MainWindow::keyUpEvent(KeyEvent &event) {
       }
     clearInput();
     }
-  player.onKeyReleased(act, mapping);
+  playerKeyReleased(act, mapping);
   }
 
 void MainWindow::focusEvent(FocusEvent &event) {
@@ -877,17 +973,30 @@ uint64_t MainWindow::tick() {
     return dt;
     }
 
+  const Replay::Frame* rf = replay.nextFrame();
+  if(rf!=nullptr) {
+    dt = rf->dt;
+    applyReplay(*rf,false);
+    }
+
   dialogs.tick(dt);
   inventory.tick(dt);
   Gothic::inst().tick(dt);
   player.tickFocus();
+  replay.markTick();
 
   if(dialogs.isActive())
     ;//clearInput();
   if(document.isActive())
     clearInput();
-  tickMouse();
+  if(rf!=nullptr) {
+    applyReplay(*rf,true);
+    dMouse = Point();
+    } else {
+    tickMouse();
+    }
   player.tickMove(dt);
+  replay.endFrame(dt);
   update();
   return dt;
   }
@@ -993,6 +1102,7 @@ Camera::Mode MainWindow::solveCameraMode() const {
 
 void MainWindow::startGame(std::string_view slot) {
   // gothic.emitGlobalSound(gothic.loadSoundFx("NEWGAME"));
+  replay.begin(slot,false);
 
   if(Gothic::inst().checkLoading()==Gothic::LoadState::Idle){
     setGameImpl(nullptr);
@@ -1008,6 +1118,7 @@ void MainWindow::startGame(std::string_view slot) {
   }
 
 void MainWindow::loadGame(std::string_view slot) {
+  replay.begin(slot,true);
   if(Gothic::inst().checkLoading()==Gothic::LoadState::Idle){
     setGameImpl(nullptr);
     onWorldLoaded();
@@ -1015,8 +1126,8 @@ void MainWindow::loadGame(std::string_view slot) {
 
   Gothic::inst().startLoad("LOADING.TGA",[slot=std::string(slot)](std::unique_ptr<GameSession>&& game){
     game = nullptr; // clear world-memory now
-    Tempest::RFile file(slot);
-    Serialize      s(file);
+    MappedFile file(slot);
+    Serialize  s(file.data(),file.size());
     std::unique_ptr<GameSession> w(new GameSession(s));
     return w;
     });
@@ -1037,9 +1148,13 @@ void MainWindow::saveGame(std::string_view slot, std::string_view name) {
     if(!game)
       return std::move(game);
 
-    Tempest::WFile f(slot);
-    Serialize      s(f);
-    game->save(s,name,pm);
+    // snapshot of game state is taken here; compression and file io are done in background
+    auto s = std::make_shared<Serialize>();
+    game->save(*s,name,pm);
+    Gothic::inst().commitSave([s,slot](){
+      Tempest::WFile f(slot);
+      s->writeArchive(f);
+      });
 
     // no print yet, because threading
     // gothic.print("Game saved");
@@ -1090,7 +1205,7 @@ void MainWindow::setGameImpl(std::unique_ptr<GameSession> &&w) {
   }
 
 void MainWindow::clearInput() {
-  player.clearInput();
+  playerClearInput();
   std::memset(mouseP,0,sizeof(mouseP));
   }
 
@@ -1113,8 +1228,11 @@ void MainWindow::render(){
       once player position is updated, animation bones(cameraBone in particular) ca be updated
       lastly - camera position
       */
+    const auto     t0 = Replay::clock::now();
     const uint64_t dt = tick();
+    const auto     t1 = Replay::clock::now();
     updateAnimation(dt);
+    replay.timing(t0,t1,Replay::clock::now());
     tickCamera(dt);
 
     auto& sync = fence[cmdId];
@@ -1163,6 +1281,7 @@ void MainWindow::render(){
       }
     fps.push(t-time);
     time = t;
+    Profiler::nextFrame();
     }
   catch(const Tempest::SwapchainSuboptimal&) {
     Log::e("swapchain is outdated - reset renderer");
@@ -25,6 +25,7 @@
 #include "world/world.h"
 #include "world/focus.h"
 #include "game/playercontrol.h"
+#include "game/replay.h"
 #include "graphics/renderer.h"
 #include "ui/dialogmenu.h"
 #include "ui/inventorymenu.h"
@@ -85,6 +86,13 @@ class MainWindow : public Tempest::Window {
     void clearInput();
     void setFullscreen(bool fs);
 
+    // player input goes through replay: recorded, or suppressed in playback
+    void playerKeyPressed (KeyCodec::Action a, Tempest::Event::KeyType key, KeyCodec::Mapping mapping = KeyCodec::Mapping::Primary);
+    void playerKeyReleased(KeyCodec::Action a, KeyCodec::Mapping mapping = KeyCodec::Mapping::Primary);
+    void playerClearInput();
+    void playerRotate(Tempest::PointF camera, float dx, float dy);
+    void applyReplay(const Replay::Frame& f, bool postTick);
+
     void processMouse(Tempest::MouseEvent& event, bool enable);
     void tickMouse();
     void onSettings();
@@ -155,6 +163,7 @@ class MainWindow : public Tempest::Window {
 
     Tempest::Widget*          uiKeyUp=nullptr;
     Tempest::Point            dMouse;
+    Replay                    replay;
     PlayerControl             player;
     uint64_t                  lastTick=0;
 
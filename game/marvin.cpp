@@ -5,6 +5,7 @@
 #include <cctype>
 
 #include "utils/string_frm.h"
+#include "utils/profiler.h"
 #include "world/objects/npc.h"
 #include "world/objects/item.h"
 #include "world/triggers/abstracttrigger.h"
@@ -146,6 +147,11 @@ Marvin::Marvin() {
 
     {"toggle gi",                  C_ToggleGI},
     {"toggle vsm",                 C_ToggleVsm},
+    {"toggle profiler",            C_ToggleProfiler},
+    {"profiler dump",              C_ProfilerDump},
+    {"toggle scriptprofiler",      C_ToggleScriptProfiler},
+    {"scriptprofiler report",      C_ScriptProfilerReport},
+    {"scriptprofiler sample %d",   C_ScriptProfilerSample},
     };
   }
 
@@ -428,6 +434,38 @@ bool Marvin::exec(std::string_view v) {
     case C_ToggleVsm:
       Gothic::inst().toggleVsm();
       return true;
+    case C_ToggleProfiler:
+      Profiler::setEnabled(!Profiler::isEnabled());
+      return true;
+    case C_ProfilerDump:
+      if(!Profiler::dumpTrace("profile.json"))
+        return false;
+      print("profiler: trace written to profile.json");
+      return true;
+    case C_ToggleScriptProfiler: {
+      auto g = Gothic::inst().gameSession();
+      if(g==nullptr)
+        return false;
+      auto& p = g->script()->profiler();
+      p.setEnabled(!p.isEnabled());
+      return true;
+      }
+    case C_ScriptProfilerReport: {
+      auto g = Gothic::inst().gameSession();
+      if(g==nullptr)
+        return false;
+      for(auto& i:g->script()->profiler().report(10))
+        print(i);
+      return true;
+      }
+    case C_ScriptProfilerSample: {
+      auto     g  = Gothic::inst().gameSession();
+      uint32_t ms = 0;
+      if(g==nullptr || !fromString(ret.argv[0], ms))
+        return false;
+      g->script()->profiler().setSampleInterval(ms);
+      return true;
+      }
     }
 
   return true;
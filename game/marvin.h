@@ -57,6 +57,11 @@ class Marvin {
       // opengothic specific
       C_ToggleGI,
       C_ToggleVsm,
+      C_ToggleProfiler,
+      C_ProfilerDump,
+      C_ToggleScriptProfiler,
+      C_ScriptProfilerReport,
+      C_ScriptProfilerSample,
       };
 
     struct Cmd {
@@ -7,11 +7,17 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 #include "graphics/mesh/submesh/packedmesh.h"
 #include "world/objects/item.h"
 #include "world/bullet.h"
 #include "world/world.h"
+#include "world/landscapecache.h"
+#include "utils/workers.h"
+#include "utils/profiler.h"
 
 const float DynamicWorld::ghostPadding=50-22.5f;
 const float DynamicWorld::ghostHeight =140;
@@ -43,8 +49,7 @@ struct DynamicWorld::NpcBody : btRigidBody {
   Tempest::Vec3 pos={};
   float         r=0, h=0, rX=0, rZ=0;
   bool          enable=true;
-  size_t        frozen=size_t(-1);
-  uint64_t      lastMove=0;
+  uint64_t      cell=0; // NpcBodyList grid cell
 
   Npc* toNpc() {
     return reinterpret_cast<Npc*>(getUserPointer());
@@ -61,14 +66,11 @@ struct DynamicWorld::NpcBody : btRigidBody {
   };
 
 struct DynamicWorld::NpcBodyList final {
-  struct Record final {
-    NpcBody* body = nullptr;
-    float    x    = 0.f;
-    };
+  // uniform grid over xz plane; bodies are re-bucketed on move only, if cell did change
+  static constexpr float CellSize = 200.f;
 
   NpcBodyList(DynamicWorld& wrld):wrld(wrld){
-    body  .reserve(1024);
-    frozen.reserve(1024);
+    body.reserve(1024);
     }
 
   NpcBody* create(const Tempest::Vec3 &min, const Tempest::Vec3 &max) {
@@ -96,45 +98,50 @@ struct DynamicWorld::NpcBodyList final {
     return obj;
     }
 
-  void add(NpcBody* b){
-    Record r;
-    r.body = b;
-    r.x    = b->pos.x;
-    body.push_back(r);
+  static int32_t cellOf(float v) {
+    return int32_t(std::floor(v/CellSize));
     }
 
-  bool del(void* b){
-    if(del(b,body))
-      return true;
-    if(del(b,frozen)){
-      srt=false;
-      return true;
-      }
-    return false;
+  static uint64_t cellKey(int32_t x, int32_t z) {
+    return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(z));
+    }
+
+  static uint64_t cellKey(const Tempest::Vec3& p) {
+    return cellKey(cellOf(p.x),cellOf(p.z));
+    }
+
+  void add(NpcBody* b){
+    body.push_back(b);
+    b->cell = cellKey(b->pos);
+    grid[b->cell].push_back(b);
     }
 
-  bool del(void* b,std::vector<Record>& arr){
-    for(size_t i=0;i<arr.size();++i){
-      if(arr[i].body!=b)
+  bool del(void* b){
+    for(size_t i=0;i<body.size();++i){
+      if(body[i]!=b)
         continue;
-      arr[i]=arr.back();
-      arr.pop_back();
+      unlink(*body[i]);
+      body[i]=body.back();
+      body.pop_back();
       return true;
       }
     return false;
     }
 
-  bool delMisordered(NpcBody* b,std::vector<Record>& arr){
-    auto&       fr = arr[b->frozen];
-    const float x  = fr.x;
-    if((b->frozen==0 || arr[b->frozen-1].x<x) &&
-       (b->frozen+1==arr.size() || x<arr[b->frozen+1].x)) {
-      fr.x = fr.body->pos.x;
-      return false;
-      } else {
-      fr.body = nullptr;
-      return true;
+  void unlink(NpcBody& n) {
+    auto it = grid.find(n.cell);
+    if(it==grid.end())
+      return;
+    auto& c = it->second;
+    for(size_t i=0; i<c.size(); ++i) {
+      if(c[i]!=&n)
+        continue;
+      c[i] = c.back();
+      c.pop_back();
+      break;
       }
+    if(c.empty())
+      grid.erase(it);
     }
 
   void resize(NpcBody& n, float h, float dx, float dz){
@@ -145,22 +152,44 @@ struct DynamicWorld::NpcBodyList final {
     n.r = std::max((dx+dz)*0.5f, dz)*0.5f;
     n.h = h;
 
-    maxR = std::max(maxR,n.r);
+    maxR    = std::max(maxR,n.r);
+    maxRayR = std::max(maxRayR,0.5f*(n.rX + n.rZ));
     }
 
   void onMove(NpcBody& n){
-    if(n.frozen!=size_t(-1)) {
-      if(delMisordered(&n,frozen)){
-        n.lastMove = tick;
-        n.frozen   = size_t(-1);
-
-        Record r;
-        r.body = &n;
-        body.push_back(r);
+    const uint64_t key = cellKey(n.pos);
+    if(key==n.cell)
+      return;
+    unlink(n);
+    n.cell = key;
+    grid[key].push_back(&n);
+    }
+
+  // calls func for bodies in cells, overlapping xz-rectangle
+  template<class F>
+  void forEach(float x0, float z0, float x1, float z1, const F& func) const {
+    const int32_t cx0 = cellOf(x0), cx1 = cellOf(x1);
+    const int32_t cz0 = cellOf(z0), cz1 = cellOf(z1);
+    const size_t  cnt = size_t(int64_t(cx1)-cx0+1)*size_t(int64_t(cz1)-cz0+1);
+    if(cnt>grid.size()) {
+      // long query: cheaper to visit occupied cells
+      for(auto& [key,c]:grid) {
+        const int32_t cx = int32_t(uint32_t(key >> 32)), cz = int32_t(uint32_t(key));
+        if(cx<cx0 || cx1<cx || cz<cz0 || cz1<cz)
+          continue;
+        for(auto b:c)
+          func(*b);
         }
-      } else {
-      n.lastMove = tick;
+      return;
       }
+    for(int32_t x=cx0; x<=cx1; ++x)
+      for(int32_t z=cz0; z<=cz1; ++z) {
+        auto it = grid.find(cellKey(x,z));
+        if(it==grid.end())
+          continue;
+        for(auto b:it->second)
+          func(*b);
+        }
     }
 
   bool rayTest(NpcBody& npc, const Tempest::Vec3& s, const Tempest::Vec3& e, float extR, float& proj) {
@@ -191,27 +220,22 @@ struct DynamicWorld::NpcBodyList final {
     }
 
   NpcBody* rayTest(const Tempest::Vec3& s, const Tempest::Vec3& e, float extR) {
-    NpcBody* ret     = nullptr;
-    float    minProj = 2;
+    NpcBody*    ret     = nullptr;
+    float       minProj = 2;
+    const float pad     = maxRayR + extR;
 
-    for(auto i:body) {
-      float proj = 0;
-      if(rayTest(*i.body, s, e, extR, proj)) {
-        if(proj<minProj) {
-          ret     = i.body;
-          minProj = proj;
-          }
-        }
-      }
-    for(auto i:frozen) {
+    const float x0      = std::min(s.x,e.x)-pad, x1 = std::max(s.x,e.x)+pad;
+    const float z0      = std::min(s.z,e.z)-pad, z1 = std::max(s.z,e.z)+pad;
+
+    forEach(x0,z0,x1,z1,[&](NpcBody& b) {
       float proj = 0;
-      if(i.body!=nullptr && rayTest(*i.body, s, e, extR, proj)) {
+      if(rayTest(b, s, e, extR, proj)) {
         if(proj<minProj) {
-          ret     = i.body;
+          ret     = &b;
           minProj = proj;
           }
         }
-      }
+      });
     return ret;
     }
 
@@ -225,38 +249,13 @@ struct DynamicWorld::NpcBodyList final {
       return false;
     const NpcBody& n = *pn;
 
-    if(srt){
-      if(hasCollision(n,frozen,normal,true))
-        return true;
-      return hasCollision(n,body,normal,false);
-      } else {
-      if(hasCollision(n,body,normal,false))
-        return true;
-      //adjustSort();
-      return hasCollision(n,frozen,normal,false);
-      }
-    }
-
-  bool hasCollision(const NpcBody& n,const std::vector<Record>& arr,Tempest::Vec3& normal, bool sorted) {
-    auto l = arr.begin();
-    auto r = arr.end();
-
-    if(sorted) {
-      const float dX = maxR+n.r;
-      l = std::lower_bound(arr.begin(),arr.end(),n.pos.x-dX,[](const Record& b,float x){ return b.x<x; });
-      r = std::upper_bound(arr.begin(),arr.end(),n.pos.x+dX,[](float x,const Record& b){ return x<b.x; });
-      }
-
-    const auto dist = std::distance(l,r);
-    if(dist<=1)
-      return false;
-
-    bool ret=false;
-    for(;l!=r;++l){
-      auto& v = (*l);
-      if(v.body!=nullptr && v.body->enable && hasCollision(n,*v.body,normal))
+    // n.pos may be a tested position, not yet committed by onMove
+    const float d   = maxR+n.r;
+    bool        ret = false;
+    forEach(n.pos.x-d, n.pos.z-d, n.pos.x+d, n.pos.z+d, [&](NpcBody& b) {
+      if(b.enable && hasCollision(n,b,normal))
         ret = true;
-      }
+      });
     return ret;
     }
 
@@ -277,54 +276,52 @@ struct DynamicWorld::NpcBodyList final {
     return true;
     }
 
-  void adjustSort() {
-    srt=true;
-    std::sort(frozen.begin(),frozen.end(),[](Record& a,Record& b){
-      return a.x < b.x;
-      });
-    for(size_t i=0; i<frozen.size(); ++i)
-      frozen[i].body->frozen = i;
-    }
+  using Cell = std::vector<NpcBody*>;
+
+  DynamicWorld&                  wrld;
+  std::vector<NpcBody*>          body;
+  std::unordered_map<uint64_t,Cell> grid;
+  float                          maxR    = 0;
+  float                          maxRayR = 0;
+  };
 
-  void tickAabbs() {
-    for(size_t i=0;i<body.size();) {
-      if(body[i].body->lastMove!=tick){
-        auto b = body[i];
-        body[i]=body.back();
-        body.pop_back();
+struct DynamicWorld::RayCache final {
+  static constexpr size_t MaxSize = 64*1024;
 
-        b.x = b.body->pos.x;
-        frozen.push_back(b);
-        } else {
-        ++i;
-        }
+  // ray endpoints, quantized to 1cm, and category mask
+  struct Key {
+    int32_t v[6] = {};
+    uint8_t mask = 0;
+    bool operator == (const Key& other) const {
+      return std::memcmp(v,other.v,sizeof(v))==0 && mask==other.mask;
       }
+    };
 
-    for(size_t i=0;i<frozen.size();) {
-      if(frozen[i].body==nullptr) {
-        frozen[i]=frozen.back();
-        frozen.pop_back();
-        }
-      else if(frozen[i].body->lastMove==tick){
-        frozen[i].body->frozen=size_t(-1);
-        body.push_back(frozen[i]);
-        frozen[i]=frozen.back();
-        frozen.pop_back();
-        }
-      else {
-        ++i;
-        }
+  struct KeyHash {
+    size_t operator()(const Key& k) const {
+      uint64_t h = k.mask;
+      for(auto i:k.v)
+        h = (h ^ uint32_t(i))*0x100000001b3ull;
+      return size_t(h ^ (h >> 32));
       }
+    };
 
-    adjustSort();
-    tick++;
+  static Key key(const Tempest::Vec3& from, const Tempest::Vec3& to, uint8_t mask) {
+    Key k;
+    const float p[6] = {from.x, from.y, from.z, to.x, to.y, to.z};
+    for(int i=0; i<6; ++i)
+      k.v[i] = int32_t(std::lround(p[i]));
+    k.mask = mask;
+    return k;
     }
 
-  DynamicWorld&         wrld;
-  std::vector<Record>   body, frozen;
-  bool                  srt=false;
-  uint64_t              tick=0;
-  float                 maxR=0;
+  void clear() {
+    std::lock_guard<std::mutex> guard(sync);
+    data.clear();
+    }
+
+  std::mutex                                    sync;
+  std::unordered_map<Key,RayLandResult,KeyHash> data;
   };
 
 struct DynamicWorld::BulletsList final {
@@ -415,7 +412,7 @@ struct DynamicWorld::BBoxList final {
   DynamicWorld&          wrld;
   };
 
-DynamicWorld::DynamicWorld(World& owner,const zenkit::Mesh& worldMesh) {
+DynamicWorld::DynamicWorld(World& owner,const zenkit::Mesh& worldMesh, const LandscapeCache& cache) {
   world.reset(new CollisionWorld());
 
   {
@@ -449,7 +446,13 @@ DynamicWorld::DynamicWorld(World& owner,const zenkit::Mesh& worldMesh) {
   if(!landMesh->isEmpty()) {
     Tempest::Matrix4x4 mt;
     mt.identity();
-    landShape.reset(new btMultimaterialTriangleMeshShape(landMesh.get(),landMesh->useQuantization(),true));
+    auto shape = new btMultimaterialTriangleMeshShape(landMesh.get(),landMesh->useQuantization(),false);
+    landShape.reset(shape);
+    landBvh = cache.loadBvh("land.bvh",*shape);
+    if(landBvh==nullptr) {
+      shape->buildOptimizedBvh();
+      cache.saveBvh("land.bvh",*shape);
+      }
     landBody = world->addCollisionBody(*landShape,mt,DynamicWorld::materialFriction(zenkit::MaterialGroup::NONE));
     landBody->setUserIndex(C_Landscape);
 
@@ -462,7 +465,13 @@ DynamicWorld::DynamicWorld(World& owner,const zenkit::Mesh& worldMesh) {
   if(!waterMesh->isEmpty()) {
     Tempest::Matrix4x4 mt;
     mt.identity();
-    waterShape.reset(new btMultimaterialTriangleMeshShape(waterMesh.get(),waterMesh->useQuantization(),true));
+    auto shape = new btMultimaterialTriangleMeshShape(waterMesh.get(),waterMesh->useQuantization(),false);
+    waterShape.reset(shape);
+    waterBvh = cache.loadBvh("water.bvh",*shape);
+    if(waterBvh==nullptr) {
+      shape->buildOptimizedBvh();
+      cache.saveBvh("water.bvh",*shape);
+      }
     waterBody = world->addCollisionBody(*waterShape,mt,0);
     waterBody->setUserIndex(C_Water);
     waterBody->setCollisionFlags(btCollisionObject::CF_STATIC_OBJECT | btCollisionObject::CF_NO_CONTACT_RESPONSE);
@@ -478,6 +487,7 @@ DynamicWorld::DynamicWorld(World& owner,const zenkit::Mesh& worldMesh) {
   npcList   .reset(new NpcBodyList(*this));
   bulletList.reset(new BulletsList(*this));
   bboxList  .reset(new BBoxList   (*this));
+  rayCache  .reset(new RayCache());
 
   world->setItemHitCallback([&](::Item& itm, zenkit::MaterialGroup mat, float impulse, float mass) {
     auto  snd = owner.addLandHitEffect(ItemMaterial(itm.handle().material),mat,itm.transform());
@@ -553,15 +563,26 @@ DynamicWorld::RayWaterResult DynamicWorld::implWaterRay(const Tempest::Vec3& fro
   }
 
 DynamicWorld::RayLandResult DynamicWorld::ray(const Tempest::Vec3& from, const Tempest::Vec3& to) const {
+  return implRay(from,to,RM_Default);
+  }
+
+DynamicWorld::RayLandResult DynamicWorld::implRay(const Tempest::Vec3& from, const Tempest::Vec3& to, uint8_t mask) const {
   struct CallBack:btCollisionWorld::ClosestRayResultCallback {
     using ClosestRayResultCallback::ClosestRayResultCallback;
     zenkit::MaterialGroup matId  = zenkit::MaterialGroup::UNDEFINED;
     const char*           sector = nullptr;
     Category              colCat = C_Null;
+    uint8_t               mask   = 0;
 
     bool needsCollision(btBroadphaseProxy* proxy0) const override {
-      auto obj=reinterpret_cast<btCollisionObject*>(proxy0->m_clientObject);
-      if(obj->getUserIndex()==C_Landscape || obj->getUserIndex()==C_Object)
+      auto    obj = reinterpret_cast<btCollisionObject*>(proxy0->m_clientObject);
+      uint8_t bit = 0;
+      switch(obj->getUserIndex()) {
+        case C_Landscape: bit = RM_Landscape; break;
+        case C_Water:     bit = RM_Water;     break;
+        case C_Object:    bit = RM_Object;    break;
+        }
+      if((mask & bit)!=0)
         return ClosestRayResultCallback::needsCollision(proxy0);
       return false;
       }
@@ -583,6 +604,7 @@ DynamicWorld::RayLandResult DynamicWorld::ray(const Tempest::Vec3& from, const T
 
   CallBack callback{CollisionWorld::toMeters(from), CollisionWorld::toMeters(to)};
   callback.m_flags = btTriangleRaycastCallback::kF_KeepUnflippedNormal | btTriangleRaycastCallback::kF_FilterBackfaces;
+  callback.mask    = mask;
 
   world->rayCast(from,to,callback);
 
@@ -660,6 +682,116 @@ float DynamicWorld::soundOclusion(const Tempest::Vec3& from, const Tempest::Vec3
   return (tlen*fr)/1.5f;
   }
 
+void DynamicWorld::rayBatch(RayBatch& b) const {
+  const size_t count = b.size();
+  b.hitPos     .resize(count);
+  b.hitNorm    .resize(count);
+  b.hitFraction.resize(count);
+  b.mat        .resize(count);
+  b.sector     .resize(count);
+  b.npcHit     .resize(count);
+  b.hasCol     .resize(count);
+  if(count==0)
+    return;
+
+  if(b.syncAabbs)
+    world->updateAabbs();
+
+  auto store = [&b](size_t i, const RayLandResult& r) {
+    b.hitPos     [i] = r.v;
+    b.hitNorm    [i] = r.n;
+    b.hitFraction[i] = r.hitFraction;
+    b.mat        [i] = r.mat;
+    b.sector     [i] = r.sector;
+    b.hasCol     [i] = r.hasCol;
+    };
+
+  std::vector<uint32_t> pending;
+  pending.reserve(count);
+  if(b.useCache) {
+    std::lock_guard<std::mutex> guard(rayCache->sync);
+    for(size_t i=0; i<count; ++i) {
+      auto it = rayCache->data.find(RayCache::key(b.from[i],b.to[i],b.mask[i]));
+      if(it!=rayCache->data.end())
+        store(i,it->second); else
+        pending.push_back(uint32_t(i));
+      }
+    } else {
+    for(size_t i=0; i<count; ++i)
+      pending.push_back(uint32_t(i));
+    }
+
+  // static bvh and broadphase are read-only here: safe to query from workers
+  Workers::parallelFor(pending,[&](uint32_t i) {
+    store(i,implRay(b.from[i],b.to[i],b.mask[i]));
+    });
+
+  if(b.useCache) {
+    std::lock_guard<std::mutex> guard(rayCache->sync);
+    for(auto i:pending) {
+      if(rayCache->data.size()>=RayCache::MaxSize)
+        break;
+      RayLandResult r;
+      r.v           = b.hitPos[i];
+      r.n           = b.hitNorm[i];
+      r.hitFraction = b.hitFraction[i];
+      r.mat         = b.mat[i];
+      r.sector      = b.sector[i];
+      r.hasCol      = b.hasCol[i];
+      rayCache->data.emplace(RayCache::key(b.from[i],b.to[i],b.mask[i]),r);
+      }
+    }
+
+  // npcs do move within a frame; test them after static geometry, same as rayNpc
+  for(size_t i=0; i<count; ++i) {
+    b.npcHit[i] = nullptr;
+    if((b.mask[i] & RM_Npc)==0)
+      continue;
+    if(auto ptr = npcList->rayTest(b.from[i],(b.hasCol[i] ? b.hitPos[i] : b.to[i]),1)) {
+      b.npcHit[i] = ptr->toNpc();
+      b.hasCol[i] = true;
+      }
+    }
+  }
+
+void DynamicWorld::RayBatch::clear() {
+  from       .clear();
+  to         .clear();
+  mask       .clear();
+  hitPos     .clear();
+  hitNorm    .clear();
+  hitFraction.clear();
+  mat        .clear();
+  sector     .clear();
+  npcHit     .clear();
+  hasCol     .clear();
+  }
+
+size_t DynamicWorld::RayBatch::add(const Tempest::Vec3& f, const Tempest::Vec3& t, uint8_t m) {
+  from.push_back(f);
+  to  .push_back(t);
+  mask.push_back(m);
+  return from.size()-1;
+  }
+
+size_t DynamicWorld::RayBatch::addLand(const Tempest::Vec3& f, float maxDy) {
+  if(maxDy==0)
+    maxDy = worldHeight;
+  return add(Tempest::Vec3(f.x,f.y+ghostPadding,f.z), Tempest::Vec3(f.x,f.y-maxDy,f.z));
+  }
+
+DynamicWorld::RayQueryResult DynamicWorld::RayBatch::result(size_t id) const {
+  RayQueryResult r;
+  r.v           = hitPos[id];
+  r.n           = hitNorm[id];
+  r.mat         = mat[id];
+  r.hasCol      = hasCol[id];
+  r.hitFraction = hitFraction[id];
+  r.sector      = sector[id];
+  r.npcHit      = npcHit[id];
+  return r;
+  }
+
 DynamicWorld::NpcItem DynamicWorld::ghostObj(std::string_view visual) {
   Tempest::Vec3 min={0,0,0}, max={0,0,0};
   if(auto sk=Resources::loadSkeleton(visual)) {
@@ -822,7 +954,8 @@ void DynamicWorld::moveBullet(BulletBody &b, const Tempest::Vec3& dir, uint64_t
   }
 
 void DynamicWorld::tick(uint64_t dt) {
-  npcList   ->tickAabbs();
+  Profiler::Zone zone("DynamicWorld::tick");
+  rayCache  ->clear();
   bulletList->tick(dt);
   world     ->tick(dt);
   }
@@ -5,6 +5,7 @@
 #include <Tempest/Matrix4x4>
 #include <memory>
 #include <limits>
+#include <vector>
 
 class btTriangleIndexVertexArray;
 class btCollisionShape;
@@ -14,6 +15,7 @@ class btVector3;
 
 class PhysicMeshShape;
 class PhysicVbo;
+class LandscapeCache;
 class PackedMesh;
 class Bounds;
 
@@ -32,6 +34,7 @@ class DynamicWorld final {
     struct NpcBodyList;
     struct BulletsList;
     struct BBoxList;
+    struct RayCache;
 
   public:
     static constexpr float gravityMS   = 9.8f; // meters per second^2
@@ -40,7 +43,7 @@ class DynamicWorld final {
     static constexpr float spellSpeed  = 1; // centimeters per milliseconds
     static const     float ghostPadding;
 
-    DynamicWorld(World &world, const zenkit::Mesh& mesh);
+    DynamicWorld(World &world, const zenkit::Mesh& mesh, const LandscapeCache& cache);
     DynamicWorld(const DynamicWorld&)=delete;
     ~DynamicWorld();
 
@@ -149,6 +152,38 @@ class DynamicWorld final {
       Npc* npcHit = nullptr;
       };
 
+    enum RayMask : uint8_t {
+      RM_Landscape = 1 << 0,
+      RM_Water     = 1 << 1,
+      RM_Object    = 1 << 2,
+      RM_Npc       = 1 << 3,
+      RM_Default   = RM_Landscape | RM_Object, // same as ray()
+      };
+
+    // closest-hit queries, executed in parallel by rayBatch; inputs and results are stored as structure of arrays
+    struct RayBatch {
+      std::vector<Tempest::Vec3>         from, to;
+      std::vector<uint8_t>               mask;
+
+      std::vector<Tempest::Vec3>         hitPos, hitNorm;
+      std::vector<float>                 hitFraction;
+      std::vector<zenkit::MaterialGroup> mat;
+      std::vector<const char*>           sector;
+      std::vector<Npc*>                  npcHit;
+      std::vector<uint8_t>               hasCol;
+
+      // reuse results of rays, identical up to 1cm, issued within same physic tick; npc hits are never cached
+      bool                               useCache  = false;
+      // false: aabbs of moved objects are taken as is, same as ray(); allows to call rayBatch from workers
+      bool                               syncAabbs = true;
+
+      size_t         size() const { return from.size(); }
+      void           clear();
+      size_t         add    (const Tempest::Vec3& from, const Tempest::Vec3& to, uint8_t mask = RM_Default);
+      size_t         addLand(const Tempest::Vec3& from, float maxDy = 0); // same as landRay
+      RayQueryResult result (size_t id) const;
+      };
+
     struct BulletCallback {
       virtual ~BulletCallback()=default;
       virtual void onStop(){}
@@ -232,6 +267,7 @@ class DynamicWorld final {
     RayLandResult  ray          (const Tempest::Vec3& from, const Tempest::Vec3& to) const;
     RayQueryResult rayNpc       (const Tempest::Vec3& from, const Tempest::Vec3& to) const;
     float          soundOclusion(const Tempest::Vec3& from, const Tempest::Vec3& to) const;
+    void           rayBatch     (RayBatch& batch) const;
 
     NpcItem        ghostObj  (std::string_view visual);
     Item           staticObj (const PhysicMeshShape *src, const Tempest::Matrix4x4& m);
@@ -263,6 +299,7 @@ class DynamicWorld final {
 
     void           moveBullet(BulletBody& b, const Tempest::Vec3& dir, uint64_t dt);
     RayWaterResult implWaterRay(const Tempest::Vec3& from, const Tempest::Vec3& to) const;
+    RayLandResult  implRay     (const Tempest::Vec3& from, const Tempest::Vec3& to, uint8_t mask) const;
     bool           hasCollision(const NpcItem &it, CollisionTest& out);
 
     std::unique_ptr<CollisionWorld>    world;
@@ -270,6 +307,8 @@ class DynamicWorld final {
     std::vector<std::string>           sectors;
 
     std::vector<btVector3>             landVbo;
+    std::unique_ptr<void,void(*)(void*)> landBvh  = {nullptr,nullptr};
+    std::unique_ptr<void,void(*)(void*)> waterBvh = {nullptr,nullptr};
     std::unique_ptr<PhysicVbo>         landMesh;
     std::unique_ptr<btCollisionShape>  landShape;
     std::unique_ptr<btRigidBody>       landBody;
@@ -281,6 +320,7 @@ class DynamicWorld final {
     std::unique_ptr<NpcBodyList>       npcList;
     std::unique_ptr<BulletsList>       bulletList;
     std::unique_ptr<BBoxList>          bboxList;
+    std::unique_ptr<RayCache>          rayCache;
 
     static const float                 ghostHeight;
     static const float                 worldHeight;
@@ -40,6 +40,56 @@ using namespace Tempest;
 
 Resources* Resources::inst=nullptr;
 
+// memory estimates for cache report and budget; gpu-side buffers are included
+static size_t textureMemory(const Texture2d& t) {
+  size_t block = 0, bpp = 4;
+  switch(t.format()) {
+    case TextureFormat::DXT1:    block = 8;  break;
+    case TextureFormat::DXT3:
+    case TextureFormat::DXT5:    block = 16; break;
+    case TextureFormat::R8:      bpp   = 1;  break;
+    case TextureFormat::R16:     bpp   = 2;  break;
+    case TextureFormat::RGBA16F: bpp   = 8;  break;
+    default:                     bpp   = 4;  break;
+    }
+
+  size_t ret = 0;
+  for(uint32_t i=0; i<std::max<uint32_t>(t.mipCount(),1); ++i) {
+    const size_t w = std::max<size_t>(size_t(t.w())>>i,1);
+    const size_t h = std::max<size_t>(size_t(t.h())>>i,1);
+    if(block>0)
+      ret += ((w+3)/4)*((h+3)/4)*block; else
+      ret += w*h*bpp;
+    }
+  return ret;
+  }
+
+static size_t meshMemory(const ProtoMesh& m) {
+  size_t ret = sizeof(m) + m.nodes.size()*sizeof(m.nodes[0]) + m.submeshId.size()*sizeof(m.submeshId[0]);
+  for(auto& i:m.attach)
+    ret += i.vbo.size()*sizeof(Resources::Vertex) + i.ibo.size()*sizeof(uint32_t) + i.ibo8.byteSize();
+  for(auto& i:m.skined)
+    ret += i.vbo.size()*sizeof(Resources::VertexA) + i.ibo.size()*sizeof(uint32_t) + i.ibo8.byteSize();
+  ret += m.morphIndex.byteSize() + m.morphSamples.byteSize();
+  return ret;
+  }
+
+static size_t animationMemory(const Animation& a) {
+  return a.memoryUsage();
+  }
+
+static size_t emitterMemory(const PfxEmitterMesh& m) {
+  return sizeof(m);
+  }
+
+static size_t vobTreeMemory(const Resources::VobTree& tree) {
+  size_t ret = 0;
+  for(auto& i:tree)
+    if(i!=nullptr)
+      ret += sizeof(*i) + vobTreeMemory(i->children);
+  return ret;
+  }
+
 static void emplaceTag(char* buf, char tag){
   for(size_t i=1;buf[i];++i){
     if(buf[i]==tag && buf[i-1]=='_' && buf[i+1]=='0'){
@@ -52,7 +102,8 @@ static void emplaceTag(char* buf, char tag){
   }
 
 Resources::Resources(Tempest::Device &device)
-  : dev(device) {
+  : dev(device), texCache(textureMemory), aniMeshCache(meshMemory), animCache(animationMemory),
+    emiMeshCache(emitterMemory), zenCache(vobTreeMemory) {
   inst=this;
 
   static std::array<VertexFsq,6> fsqBuf =
@@ -85,8 +136,6 @@ Resources::Resources(Tempest::Device &device)
   // switch-build
   dxMusic->addPath(Gothic::nestedPath({u"_work",u"Data",u"Music"},Dir::FT_Dir));
 
-  fBuff .reserve(8*1024*1024);
-  ddsBuf.reserve(8*1024*1024);
 
   {
   Pixmap pm(1,1,TextureFormat::RGBA8);
@@ -192,7 +241,7 @@ Resources::~Resources() {
   }
 
 bool Resources::hasFile(std::string_view name) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
+  // vfs is immutable after loadVdfs
   return inst->gothicAssets.find(name) != nullptr;
   }
 
@@ -353,23 +402,12 @@ int64_t Resources::vdfTimestamp(const std::u16string& name) {
     }
   }
 
-Tempest::Texture2d* Resources::implLoadTexture(std::string_view cname, bool forceMips) {
-  if(cname.empty())
-    return nullptr;
-
-  std::string name = std::string(cname);
-  auto it=texCache.find(name);
-  if(it!=texCache.end())
-    return it->second.get();
-
-  if(FileExt::hasExt(name,"TGA")) {
+std::unique_ptr<Texture2d> Resources::implLoadTexture(std::string_view cname, bool forceMips) {
+  if(FileExt::hasExt(cname,"TGA")) {
+    std::string name = std::string(cname);
     name.resize(name.size() + 2);
     std::memcpy(&name[0]+name.size()-6,"-C.TEX",6);
 
-    it=texCache.find(name);
-    if(it!=texCache.end())
-      return it->second.get();
-
     if(const auto* entry = Resources::vdfsIndex().find(name)) {
       zenkit::Texture tex;
 
@@ -384,8 +422,7 @@ Tempest::Texture2d* Resources::implLoadTexture(std::string_view cname, bool forc
         auto dds = zenkit::to_dds(tex);
         auto ddsRead = zenkit::Read::from(dds);
 
-        auto t = implLoadTexture(std::string(cname), *ddsRead, forceMips);
-        if(t!=nullptr)
+        if(auto t = implLoadTexture(*ddsRead, forceMips))
           return t;
         } else {
         auto rgba = tex.as_rgba8(0);
@@ -393,11 +430,7 @@ Tempest::Texture2d* Resources::implLoadTexture(std::string_view cname, bool forc
         try {
           Tempest::Pixmap    pm(tex.width(), tex.height(), TextureFormat::RGBA8);
           std::memcpy(pm.data(), rgba.data(), rgba.size());
-
-          std::unique_ptr<Texture2d> t{new Texture2d(dev.texture(pm))};
-          Texture2d* ret=t.get();
-          texCache[std::move(name)] = std::move(t);
-          return ret;
+          return std::unique_ptr<Texture2d>{new Texture2d(dev.texture(pm))};
           }
         catch (...) {
           }
@@ -407,14 +440,13 @@ Tempest::Texture2d* Resources::implLoadTexture(std::string_view cname, bool forc
 
   if(auto* entry = Resources::vdfsIndex().find(cname)) {
     auto reader = entry->open_read();
-    return implLoadTexture(std::string(cname), *reader, forceMips);
+    return implLoadTexture(*reader, forceMips);
     }
 
-  texCache[name]=nullptr;
   return nullptr;
   }
 
-Texture2d *Resources::implLoadTexture(std::string&& name, zenkit::Read& data, bool forceMips) {
+std::unique_ptr<Texture2d> Resources::implLoadTexture(zenkit::Read& data, bool forceMips) {
   try {
     std::vector<uint8_t> raw;
     data.seek(0, zenkit::Whence::END);
@@ -426,28 +458,16 @@ Texture2d *Resources::implLoadTexture(std::string&& name, zenkit::Read& data, bo
     Tempest::Pixmap    pm(rd);
 
     const bool useMipmap = forceMips || (pm.mipCount()>1); // do not generate mips, if original texture has has none
-    std::unique_ptr<Texture2d> t{new Texture2d(dev.texture(pm, useMipmap))};
-    Texture2d* ret=t.get();
-    texCache[std::move(name)] = std::move(t);
-    return ret;
+    return std::unique_ptr<Texture2d>{new Texture2d(dev.texture(pm, useMipmap))};
     }
   catch(...){
     return nullptr;
     }
   }
 
-ProtoMesh* Resources::implLoadMesh(std::string_view name) {
-  if(name.size()==0)
-    return nullptr;
-
+std::unique_ptr<ProtoMesh> Resources::implLoadMesh(std::string_view name) {
   auto cname = std::string(name);
-  auto it    = aniMeshCache.find(cname);
-  if(it!=aniMeshCache.end())
-    return it->second.get();
-
-  auto  t   = implLoadMeshMain(cname);
-  auto  ret = t.get();
-  aniMeshCache[cname] = std::move(t);
+  auto ret   = implLoadMeshMain(cname);
   if(ret==nullptr)
     Log::e("unable to load mesh \"",cname,"\"");
   return ret;
@@ -571,14 +591,9 @@ std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
   return nullptr;
   }
 
-PfxEmitterMesh* Resources::implLoadEmiterMesh(std::string_view name) {
+std::unique_ptr<PfxEmitterMesh> Resources::implLoadEmiterMesh(std::string_view name) {
   // TODO: reuse code from Resources::implLoadMeshMain
   auto cname = std::string(name);
-  auto it    = emiMeshCache.find(cname);
-  if(it!=emiMeshCache.end())
-    return it->second.get();
-
-  auto& ret = emiMeshCache[cname];
 
   if(FileExt::hasExt(cname,"3DS")) {
     FileExt::exchangeExt(cname,"3DS","MRM");
@@ -593,8 +608,7 @@ PfxEmitterMesh* Resources::implLoadEmiterMesh(std::string_view name) {
       return nullptr;
 
     PackedMesh packed(zmsh,PackedMesh::PK_Visual);
-    ret = std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(packed));
-    return ret.get();
+    return std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(packed));
     }
 
   if(FileExt::hasExt(name,"MDM")) {
@@ -608,8 +622,7 @@ PfxEmitterMesh* Resources::implLoadEmiterMesh(std::string_view name) {
     auto reader = entry->open_read();
     mdm.load(reader.get());
 
-    ret = std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(std::move(mdm)));
-    return ret.get();
+    return std::unique_ptr<PfxEmitterMesh>(new PfxEmitterMesh(std::move(mdm)));
     }
 
   return nullptr;
@@ -698,10 +711,11 @@ Tempest::Sound Resources::implLoadSoundBuffer(std::string_view name) {
   if(name.empty())
     return Tempest::Sound();
 
-  if(!getFileData(name,fBuff))
+  std::vector<uint8_t> data;
+  if(!getFileData(name,data))
     return Tempest::Sound();
   try {
-    Tempest::MemReader rd(fBuff.data(),fBuff.size());
+    Tempest::MemReader rd(data.data(),data.size());
     return Tempest::Sound(rd);
     }
   catch(...) {
@@ -778,8 +792,9 @@ GthFont &Resources::implLoadFont(std::string_view name, FontType type) {
   }
 
 const Texture2d *Resources::loadTexture(std::string_view name, bool forceMips) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadTexture(name,forceMips);
+  if(name.empty())
+    return nullptr;
+  return inst->texCache.get(name,[name,forceMips](){ return inst->implLoadTexture(name,forceMips); });
   }
 
 const Texture2d* Resources::loadTexture(Tempest::Color color) {
@@ -872,15 +887,13 @@ Material Resources::loadMaterial(const zenkit::Material& src, bool enableAlphaTe
 const ProtoMesh* Resources::loadMesh(std::string_view name) {
   if(name.size()==0)
     return nullptr;
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadMesh(name);
+  return inst->aniMeshCache.get(name,[name](){ return inst->implLoadMesh(name); });
   }
 
 const PfxEmitterMesh* Resources::loadEmiterMesh(std::string_view name) {
   if(name.empty())
     return nullptr;
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadEmiterMesh(name);
+  return inst->emiMeshCache.get(name,[name](){ return inst->implLoadEmiterMesh(name); });
   }
 
 const Skeleton* Resources::loadSkeleton(std::string_view name) {
@@ -891,24 +904,73 @@ const Skeleton* Resources::loadSkeleton(std::string_view name) {
   }
 
 const Animation* Resources::loadAnimation(std::string_view name) {
-  auto cname = std::string(name);
-
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  auto& cache = inst->animCache;
-  auto it=cache.find(cname);
-  if(it!=cache.end())
-    return it->second.get();
-  auto t       = inst->implLoadAnimation(cname);
-  auto ret     = t.get();
-  cache[cname] = std::move(t);
-  return ret;
+  return inst->animCache.get(name,[name](){ return inst->implLoadAnimation(std::string(name)); });
   }
 
 Tempest::Sound Resources::loadSoundBuffer(std::string_view name) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
   return inst->implLoadSoundBuffer(name);
   }
 
+auto Resources::loadTextureAsync(std::string_view name, bool forceMips) -> Workers::Future<const Texture2d*> {
+  return Workers::async([name = std::string(name),forceMips](){ return loadTexture(name,forceMips); });
+  }
+
+auto Resources::loadMeshAsync(std::string_view name) -> Workers::Future<const ProtoMesh*> {
+  return Workers::async([name = std::string(name)](){ return loadMesh(name); });
+  }
+
+auto Resources::loadAnimationAsync(std::string_view name) -> Workers::Future<const Animation*> {
+  return Workers::async([name = std::string(name)](){ return loadAnimation(name); });
+  }
+
+auto Resources::loadSoundBufferAsync(std::string_view name) -> Workers::Future<Tempest::Sound> {
+  return Workers::async([name = std::string(name)](){ return loadSoundBuffer(name); });
+  }
+
+Resources::VobTreeHandle Resources::acquireVobBundle(std::string_view name) {
+  return inst->zenCache.acquire(name,[name](){ return inst->implLoadVobBundle(name); });
+  }
+
+void Resources::beginCacheEpoch() {
+  inst->zenCache.nextEpoch();
+  }
+
+size_t Resources::trimCaches() {
+  // only vob bundles are handed out as handles: bundles, not used by current world, are released.
+  // Textures, meshes, animations and emitters are raw pointers and stay resident
+  const size_t freed = inst->zenCache.trim(size_t(-1));
+
+  for(auto& i:cacheStats()) {
+    Log::i("cache[",i.name,"]: ",i.count," assets (",i.pinned," pinned), ",
+           i.memory/1024," Kb, ",i.evicted," evicted");
+    }
+  return freed;
+  }
+
+std::vector<Resources::CacheStats> Resources::cacheStats() {
+  std::vector<CacheStats> ret;
+  auto add = [&ret](const char* name, const auto& cache) {
+    auto       s  = cache.stats();
+    CacheStats st;
+    st.name     = name;
+    st.hit      = s.hit;
+    st.miss     = s.miss;
+    st.wait     = s.wait;
+    st.loadTime = s.loadTime;
+    st.count    = s.count;
+    st.pinned   = s.pinned;
+    st.memory   = s.memory;
+    st.evicted  = s.evicted;
+    ret.push_back(st);
+    };
+  add("texture",   inst->texCache);
+  add("mesh",      inst->aniMeshCache);
+  add("animation", inst->animCache);
+  add("emitter",   inst->emiMeshCache);
+  add("zen",       inst->zenCache);
+  return ret;
+  }
+
 Dx8::PatternList Resources::loadDxMusic(std::string_view name) {
   std::lock_guard<std::recursive_mutex> g(inst->sync);
   return inst->implLoadDxMusic(name);
@@ -924,11 +986,6 @@ const ProtoMesh* Resources::decalMesh(const zenkit::VisualDecal& decal) {
   return inst->implDecalMesh(decal);
   }
 
-const Resources::VobTree* Resources::loadVobBundle(std::string_view name) {
-  std::lock_guard<std::recursive_mutex> g(inst->sync);
-  return inst->implLoadVobBundle(name);
-  }
-
 void Resources::resetRecycled(uint8_t fId) {
   std::lock_guard<std::recursive_mutex> g(inst->sync);
   inst->recycledId = fId;
@@ -958,11 +1015,8 @@ void Resources::recycle(Tempest::StorageImage&& img) {
   inst->recycled[inst->recycledId].img.emplace_back(std::move(img));
   }
 
-const Resources::VobTree* Resources::implLoadVobBundle(std::string_view filename) {
+std::unique_ptr<Resources::VobTree> Resources::implLoadVobBundle(std::string_view filename) {
   auto cname = std::string(filename);
-  auto i     = zenCache.find(cname);
-  if(i!=zenCache.end())
-    return i->second.get();
 
   std::vector<std::shared_ptr<zenkit::VirtualObject>> bundle;
   try {
@@ -982,8 +1036,7 @@ const Resources::VobTree* Resources::implLoadVobBundle(std::string_view filename
     Log::e("unable to load Zen-file: \"",cname,"\"");
     }
 
-  auto ret = zenCache.insert(std::make_pair(filename,std::make_unique<VobTree>(std::move(bundle))));
-  return ret.first->second.get();
+  return std::make_unique<VobTree>(std::move(bundle));
   }
 
 const AttachBinder *Resources::bindMesh(const ProtoMesh &anim, const Skeleton &s) {
@@ -14,6 +14,8 @@
 
 #include "graphics/material.h"
 #include "sound/soundfx.h"
+#include "utils/assetcache.h"
+#include "utils/workers.h"
 
 struct DmSegment;
 struct DmLoader;
@@ -81,6 +83,20 @@ class Resources final {
 
     using VobTree = std::vector<std::shared_ptr<zenkit::VirtualObject>>;
 
+    struct CacheStats {
+      const char* name     = "";
+      uint64_t    hit      = 0;
+      uint64_t    miss     = 0;
+      uint64_t    wait     = 0;
+      uint64_t    loadTime = 0;
+      size_t      count    = 0;
+      size_t      pinned   = 0;
+      size_t      memory   = 0;
+      uint64_t    evicted  = 0;
+      };
+
+    using VobTreeHandle   = AssetCache<VobTree>::Handle;
+
     static Tempest::Device&          device() { return inst->dev; }
     static const char*               renderer();
     static void                      loadVdfs(const std::vector<std::u16string> &modvdfs, bool modFilter);
@@ -110,12 +126,23 @@ class Resources final {
     static const Animation*          loadAnimation  (std::string_view name);
     static Tempest::Sound            loadSoundBuffer(std::string_view name);
 
+    static auto                      loadTextureAsync  (std::string_view name, bool forceMips = false) -> Workers::Future<const Tempest::Texture2d*>;
+    static auto                      loadMeshAsync     (std::string_view name) -> Workers::Future<const ProtoMesh*>;
+    static auto                      loadAnimationAsync(std::string_view name) -> Workers::Future<const Animation*>;
+    static auto                      loadSoundBufferAsync(std::string_view name) -> Workers::Future<Tempest::Sound>;
+
+    // reference counted access: asset can be evicted, once last handle is gone.
+    // Textures, meshes and animations are handed out as raw pointers and stay resident
+    static VobTreeHandle             acquireVobBundle(std::string_view name);
+
+    static std::vector<CacheStats>   cacheStats();
+    static void                      beginCacheEpoch();
+    static size_t                    trimCaches();
+
     static Dx8::PatternList          loadDxMusic(std::string_view name);
     static DmSegment*                loadMusicSegment(char const* name);
     static const ProtoMesh*          decalMesh(const zenkit::VisualDecal& decal);
 
-    static const VobTree*            loadVobBundle(std::string_view name);
-
     template<class V>
     static Tempest::VertexBuffer<V>  vbo(const V* data,size_t sz){ return inst->dev.vbo(data,sz); }
 
@@ -174,14 +201,12 @@ class Resources final {
         }
       };
 
-    using TextureCache = std::unordered_map<std::string,std::unique_ptr<Tempest::Texture2d>>;
-
     int64_t               vdfTimestamp(const std::u16string& name);
     void                  detectVdf(std::vector<Archive>& ret, const std::u16string& root);
 
-    Tempest::Texture2d*   implLoadTexture(std::string_view cname, bool forceMips);
-    Tempest::Texture2d*   implLoadTexture(std::string &&name, zenkit::Read& data, bool forceMips);
-    ProtoMesh*            implLoadMesh(std::string_view name);
+    std::unique_ptr<Tempest::Texture2d> implLoadTexture(std::string_view cname, bool forceMips);
+    std::unique_ptr<Tempest::Texture2d> implLoadTexture(zenkit::Read& data, bool forceMips);
+    std::unique_ptr<ProtoMesh> implLoadMesh(std::string_view name);
     std::unique_ptr<ProtoMesh> implLoadMeshMain(std::string name);
     std::unique_ptr<Animation> implLoadAnimation(std::string name);
     ProtoMesh*            implDecalMesh(const zenkit::VisualDecal& decal);
@@ -189,8 +214,8 @@ class Resources final {
     Dx8::PatternList      implLoadDxMusic(std::string_view name);
     DmSegment*            implLoadMusicSegment(char const* name);
     GthFont&              implLoadFont(std::string_view fname, FontType type);
-    PfxEmitterMesh*       implLoadEmiterMesh(std::string_view name);
-    const VobTree*        implLoadVobBundle(std::string_view name);
+    std::unique_ptr<PfxEmitterMesh> implLoadEmiterMesh(std::string_view name);
+    std::unique_ptr<VobTree>        implLoadVobBundle(std::string_view name);
 
     Tempest::VertexBuffer<Vertex> sphere(int passCount, float R);
 
@@ -229,7 +254,6 @@ class Resources final {
     DmLoader*                         dmLoader = nullptr;
     zenkit::Vfs                       gothicAssets;
 
-    std::vector<uint8_t>              fBuff, ddsBuf;
     Tempest::VertexBuffer<VertexFsq>  fsq;
     Tempest::IndexBuffer<uint16_t>    cube;
 
@@ -241,15 +265,17 @@ class Resources final {
     DeleteQueue recycled[MaxFramesInFlight];
     uint8_t     recycledId = 0;
 
-    TextureCache                                                      texCache;
+    // named assets: lock per shard, decoding is done without lock
+    AssetCache<Tempest::Texture2d>                                    texCache;
+    AssetCache<ProtoMesh>                                             aniMeshCache;
+    AssetCache<Animation>                                             animCache;
+    AssetCache<PfxEmitterMesh>                                        emiMeshCache;
+    AssetCache<VobTree>                                               zenCache;
+
+    // cheap to create, guarded by sync
     std::map<Tempest::Color,std::unique_ptr<Tempest::Texture2d>,Less> pixCache;
-    std::unordered_map<std::string,std::unique_ptr<ProtoMesh>>        aniMeshCache;
     std::unordered_map<DecalK,std::unique_ptr<ProtoMesh>,Hash>        decalMeshCache;
-    std::unordered_map<std::string,std::unique_ptr<Skeleton>>         skeletonCache;
-    std::unordered_map<std::string,std::unique_ptr<Animation>>        animCache;
     std::unordered_map<BindK,std::unique_ptr<AttachBinder>,Hash>      bindCache;
-    std::unordered_map<std::string,std::unique_ptr<PfxEmitterMesh>>   emiMeshCache;
-    std::unordered_map<std::string,std::unique_ptr<VobTree>>          zenCache;
 
     std::recursive_mutex                                              syncFont;
     std::unordered_map<FontK,std::unique_ptr<GthFont>,Hash>           gothicFnt;
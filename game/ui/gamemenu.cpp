@@ -13,6 +13,7 @@
 #include "ui/menuroot.h"
 #include "utils/gthfont.h"
 #include "utils/fileutil.h"
+#include "utils/mappedfile.h"
 #include "utils/keycodec.h"
 #include "game/definitions/musicdefinitions.h"
 #include "game/serialize.h"
@@ -997,8 +998,8 @@ void GameMenu::updateSavTitle(GameMenu::Item& sel) {
 
   SaveGameHeader hdr;
   try {
-    RFile     fin(fname);
-    Serialize reader(fin);
+    MappedFile fin(fname);
+    Serialize  reader(fin.data(),fin.size());
     reader.setEntry("header");
     reader.read(hdr);
     if(id!=0 || sel.handle->text[0].empty())
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
+#include "utils/workers.h"
+
+// loads, in progress on current thread, over all caches
+struct AssetCacheLoads {
+  static inline thread_local uint32_t inFlight = 0;
+  };
+
+// name -> asset cache, with per-shard locking; loading is done outside of lock,
+// concurrent requests of the same asset wait for the first one instead of loading it twice
+template<class T>
+class AssetCache final {
+  private:
+    struct Slot;
+
+  public:
+    struct Stats {
+      uint64_t hit      = 0;
+      uint64_t miss     = 0;
+      uint64_t wait     = 0;
+      uint64_t loadTime = 0; // microseconds, sum over all loads
+      size_t   count    = 0;
+      size_t   pinned   = 0;
+      size_t   memory   = 0;
+      uint64_t evicted  = 0;
+      };
+
+    // reference counted asset; unreferenced assets may be evicted by trim()
+    class Handle {
+      public:
+        Handle() = default;
+        Handle(const Handle& h):slot(h.slot) { if(slot!=nullptr) slot->refs.fetch_add(1,std::memory_order_relaxed); }
+        Handle(Handle&& h) noexcept :slot(h.slot) { h.slot = nullptr; }
+        ~Handle() { if(slot!=nullptr) slot->refs.fetch_sub(1,std::memory_order_release); }
+
+        Handle& operator = (const Handle& h) { Handle tmp(h); std::swap(slot,tmp.slot); return *this; }
+        Handle& operator = (Handle&& h) noexcept { std::swap(slot,h.slot); return *this; }
+
+        T*       get()        const { return slot!=nullptr ? slot->value.get() : nullptr; }
+        T*       operator->() const { return get(); }
+        T&       operator*()  const { return *get(); }
+        explicit operator bool() const { return get()!=nullptr; }
+
+      private:
+        explicit Handle(Slot* s):slot(s) {} // reference is taken by AssetCache
+        Slot* slot = nullptr;
+
+      friend class AssetCache;
+      };
+
+    explicit AssetCache(std::function<size_t(const T&)> sizeOf = [](const T&){ return sizeof(T); })
+      :sizeOf(std::move(sizeOf)) {}
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator = (const AssetCache&) = delete;
+
+    // raw pointer owners can't be tracked: asset stays resident until cache is destroyed
+    template<class F>
+    T* get(std::string_view name, const F& load) {
+      return result(*lookup(name,load,true));
+      }
+
+    template<class F>
+    Handle acquire(std::string_view name, const F& load) {
+      Slot* sl = lookup(name,load,false);
+      Handle h(sl);
+      result(*sl);
+      return h;
+      }
+
+    void   nextEpoch()         { epoch.fetch_add(1); }
+    size_t memoryUsage() const { return memory.load(); }
+
+    // evict least recently used, unreferenced assets, not touched in current epoch; until 'bytes' are freed
+    size_t trim(size_t bytes) {
+      const uint64_t ep = epoch.load();
+      if(bytes==0)
+        return 0;
+
+      struct Candidate {
+        Shard*      shard   = nullptr;
+        std::string name;
+        uint64_t    lastUse = 0;
+        };
+      std::vector<Candidate> lru;
+      for(auto& s:shard) {
+        std::lock_guard<std::mutex> lck(s.sync);
+        for(auto& [name,sl]:s.data)
+          if(isEvictable(*sl,ep))
+            lru.push_back({&s,name,sl->lastUse});
+        }
+      std::sort(lru.begin(),lru.end(),[](const Candidate& a, const Candidate& b){ return a.lastUse<b.lastUse; });
+
+      size_t freed = 0;
+      for(auto& c:lru) {
+        if(freed>=bytes)
+          break;
+        std::unique_ptr<Slot> victim;
+        {
+        std::lock_guard<std::mutex> lck(c.shard->sync);
+        auto it = c.shard->data.find(c.name);
+        if(it==c.shard->data.end() || !isEvictable(*it->second,ep))
+          continue;
+        victim = std::move(it->second);
+        c.shard->data.erase(it);
+        }
+        memory.fetch_sub(victim->memory);
+        freed += victim->memory;
+        evicted.fetch_add(1,std::memory_order_relaxed);
+        }
+      return freed;
+      }
+
+    Stats stats() const {
+      Stats st;
+      st.hit      = hit.load();
+      st.miss     = miss.load();
+      st.wait     = wait.load();
+      st.loadTime = loadTime.load();
+      st.memory   = memory.load();
+      st.evicted  = evicted.load();
+      for(auto& s:shard) {
+        std::lock_guard<std::mutex> lck(s.sync);
+        st.count += s.data.size();
+        for(auto& i:s.data)
+          if(i.second->pinned)
+            st.pinned++;
+        }
+      return st;
+      }
+
+  private:
+    struct Slot {
+      std::unique_ptr<T>    value;
+      std::exception_ptr    error;
+      std::thread::id       loader;
+      std::atomic<uint32_t> refs{0};
+      uint64_t              lastUse = 0;
+      size_t                memory  = 0;
+      bool                  pinned  = false;
+      bool                  ready   = false;
+      };
+
+    struct alignas(64) Shard {
+      mutable std::mutex      sync;
+      std::condition_variable readyWait;
+      std::unordered_map<std::string,std::unique_ptr<Slot>> data;
+      };
+
+    // under shard lock
+    void use(Slot& sl, bool pin) {
+      sl.lastUse = epoch.load(std::memory_order_relaxed);
+      if(pin)
+        sl.pinned = true; else
+        sl.refs.fetch_add(1,std::memory_order_relaxed);
+      }
+
+    static bool isEvictable(const Slot& sl, uint64_t ep) {
+      return sl.ready && !sl.pinned && sl.lastUse<ep && sl.refs.load(std::memory_order_acquire)==0;
+      }
+
+    template<class F>
+    Slot* lookup(std::string_view name, const F& load, bool pin) {
+      Shard& s  = shard[std::hash<std::string_view>()(name)%shardCount];
+      Slot*  sl = nullptr;
+      {
+      std::unique_lock<std::mutex> lck(s.sync);
+      auto it = s.data.find(std::string(name));
+      if(it==s.data.end()) {
+        auto ptr = std::make_unique<Slot>();
+        ptr->loader = std::this_thread::get_id();
+        sl = ptr.get();
+        s.data.emplace(std::string(name),std::move(ptr));
+        miss.fetch_add(1,std::memory_order_relaxed);
+        }
+      else if(it->second->ready) {
+        hit.fetch_add(1,std::memory_order_relaxed);
+        use(*it->second,pin);
+        return it->second.get();
+        }
+      else if(it->second->loader!=std::this_thread::get_id() && AssetCacheLoads::inFlight==0) {
+        sl = it->second.get();
+        wait.fetch_add(1,std::memory_order_relaxed);
+        // help Workers, instead of blocking: loader may wait for a job, queued by this thread
+        while(!sl->ready) {
+          lck.unlock();
+          const bool busy = Workers::tryRunJob();
+          lck.lock();
+          if(!busy && !sl->ready)
+            s.readyWait.wait_for(lck,std::chrono::milliseconds(1));
+          }
+        use(*sl,pin);
+        return sl;
+        }
+      else {
+        // this thread has a load in flight: waiting for other loader may close a cycle
+        // (each thread waits for asset of another, picked up as stolen job), so load again.
+        // Same thread, nested request: Workers ran unrelated job while waiting, load again
+        sl = it->second.get();
+        }
+      }
+
+      auto               t0 = std::chrono::steady_clock::now();
+      std::unique_ptr<T> val;
+      std::exception_ptr err;
+      AssetCacheLoads::inFlight++;
+      try {
+        val = load();
+        }
+      catch(...) {
+        err = std::current_exception();
+        }
+      AssetCacheLoads::inFlight--;
+      auto dt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-t0);
+      loadTime.fetch_add(uint64_t(dt.count()),std::memory_order_relaxed);
+
+      {
+      std::lock_guard<std::mutex> lck(s.sync);
+      if(!sl->ready) {
+        sl->memory = (val!=nullptr ? sizeOf(*val) : 0);
+        sl->value  = std::move(val);
+        sl->error  = err;
+        sl->ready  = true;
+        memory.fetch_add(sl->memory);
+        }
+      use(*sl,pin);
+      }
+      s.readyWait.notify_all();
+      return sl;
+      }
+
+    static T* result(const Slot& sl) {
+      if(sl.error!=nullptr)
+        std::rethrow_exception(sl.error);
+      return sl.value.get();
+      }
+
+    static constexpr size_t shardCount = 16;
+
+    std::function<size_t(const T&)> sizeOf;
+    Shard                 shard[shardCount];
+    std::atomic<uint64_t> hit{0};
+    std::atomic<uint64_t> miss{0};
+    std::atomic<uint64_t> wait{0};
+    std::atomic<uint64_t> loadTime{0};
+    std::atomic<uint64_t> evicted{0};
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<size_t>   memory{0};
+  };
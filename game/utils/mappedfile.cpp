@@ -0,0 +1,75 @@
+#include "mappedfile.h"
+
+#include <Tempest/Platform>
+#include <Tempest/TextCodec>
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::string_view path) {
+  const std::string spath(path);
+#ifdef __WINDOWS__
+  std::u16string wpath = Tempest::TextCodec::toUtf16(spath.c_str());
+  HANDLE file = CreateFileW(reinterpret_cast<const WCHAR*>(wpath.c_str()), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(file!=INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER sz = {};
+    if(GetFileSizeEx(file,&sz) && sz.QuadPart>0) {
+      HANDLE m = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if(m!=nullptr) {
+        void* view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(m);
+        if(view!=nullptr) {
+          ptr = reinterpret_cast<const uint8_t*>(view);
+          len = size_t(sz.QuadPart);
+          map = view;
+          }
+        }
+      }
+    CloseHandle(file);
+    }
+#else
+  int fd = ::open(spath.c_str(), O_RDONLY);
+  if(fd>=0) {
+    struct stat st = {};
+    if(::fstat(fd,&st)==0 && st.st_size>0) {
+      void* view = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if(view!=MAP_FAILED) {
+        ptr = reinterpret_cast<const uint8_t*>(view);
+        len = size_t(st.st_size);
+        map = view;
+        }
+      }
+    ::close(fd);
+    }
+#endif
+
+  if(map!=nullptr)
+    return;
+
+  // empty or unmappable file: read it as is; RFile throws, if file doesn't exist
+  Tempest::RFile fin(spath);
+  copy.resize(fin.size());
+  if(fin.read(copy.data(),copy.size())!=copy.size())
+    Tempest::Log::e("MappedFile: unable to read \"",path,"\"");
+  ptr = copy.data();
+  len = copy.size();
+  }
+
+MappedFile::~MappedFile() {
+  if(map==nullptr)
+    return;
+#ifdef __WINDOWS__
+  UnmapViewOfFile(map);
+#else
+  ::munmap(map,len);
+#endif
+  }
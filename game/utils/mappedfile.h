@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// read-only view of a whole file; pages are loaded by the OS on first access
+class MappedFile final {
+  public:
+    explicit MappedFile(std::string_view path);
+    MappedFile(const MappedFile&) = delete;
+    ~MappedFile();
+
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    const uint8_t* data() const { return ptr; }
+    size_t         size() const { return len; }
+
+  private:
+    const uint8_t*       ptr = nullptr;
+    size_t               len = 0;
+    void*                map = nullptr;
+    // fallback, if mapping is not possible
+    std::vector<uint8_t> copy;
+  };
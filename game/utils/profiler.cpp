@@ -0,0 +1,202 @@
+#include "profiler.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+using namespace Tempest;
+
+static constexpr size_t RingSize = 1u << 16;
+
+namespace {
+struct Event final {
+  const char* name  = nullptr;
+  uint64_t    begin = 0; // nanoseconds
+  uint64_t    end   = 0;
+  };
+
+// ring is written by owner thread and read by nextFrame/dumpTrace: both sides take the lock,
+// which is uncontended most of the time
+struct Buffer final {
+  std::mutex            sync;
+  std::vector<Event>    ring   = std::vector<Event>(RingSize);
+  uint64_t              head   = 0;
+  uint64_t              cursor = 0; // first event, not accounted in frame statistic yet
+  uint32_t              tid    = 0;
+  bool                  inUse  = true;
+  };
+
+struct ZoneHistory final {
+  std::string_view name;
+  uint64_t         frame = 0;
+  uint64_t         samples[Profiler::FrameHistory] = {};
+  size_t           count = 0;
+  size_t           at    = 0;
+  };
+}
+
+static std::mutex                           bufSync;
+static std::vector<std::unique_ptr<Buffer>> buffers;
+static std::vector<ZoneHistory>             zones;
+
+namespace {
+// buffer of finished thread is kept for trace dump, and reused by next new thread
+struct ThreadBuffer final {
+  Buffer* buf = nullptr;
+  ~ThreadBuffer() {
+    if(buf==nullptr)
+      return;
+    std::lock_guard<std::mutex> guard(bufSync);
+    buf->inUse = false;
+    }
+  };
+}
+
+static Buffer& threadBuffer() {
+  static thread_local ThreadBuffer tb;
+  if(tb.buf!=nullptr)
+    return *tb.buf;
+
+  std::lock_guard<std::mutex> guard(bufSync);
+  for(auto& b:buffers)
+    if(!b->inUse) {
+      b->inUse = true;
+      tb.buf   = b.get();
+      return *tb.buf;
+      }
+  auto b = std::make_unique<Buffer>();
+  b->tid = uint32_t(buffers.size());
+  tb.buf = b.get();
+  buffers.emplace_back(std::move(b));
+  return *tb.buf;
+  }
+
+uint64_t Profiler::now() {
+  using namespace std::chrono;
+  return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+  }
+
+void Profiler::push(const char* name, uint64_t begin, uint64_t end) {
+  auto& b = threadBuffer();
+  std::lock_guard<std::mutex> guard(b.sync);
+  auto& e = b.ring[b.head%RingSize];
+  e.name  = name;
+  e.begin = begin;
+  e.end   = end;
+  b.head++;
+  }
+
+void Profiler::setEnabled(bool e) {
+  std::lock_guard<std::mutex> guard(bufSync);
+  if(e && !enabled.load()) {
+    // statistic starts over
+    for(auto& b:buffers) {
+      std::lock_guard<std::mutex> g(b->sync);
+      b->cursor = b->head;
+      }
+    zones.clear();
+    }
+  enabled.store(e);
+  Log::i("profiler: ", e ? "enabled" : "disabled");
+  }
+
+void Profiler::nextFrame() {
+  if(!isEnabled())
+    return;
+
+  std::lock_guard<std::mutex> guard(bufSync);
+  for(auto& b:buffers) {
+    std::lock_guard<std::mutex> g(b->sync);
+    const uint64_t head = b->head;
+    const uint64_t from = std::max(b->cursor, head>RingSize ? head-RingSize : 0);
+    for(uint64_t i=from; i<head; ++i) {
+      auto& e = b->ring[i%RingSize];
+      auto  z = std::find_if(zones.begin(),zones.end(),[&e](const ZoneHistory& h){
+        return h.name.data()==e.name || h.name==e.name;
+        });
+      if(z==zones.end()) {
+        zones.emplace_back();
+        z = zones.end()-1;
+        z->name = e.name;
+        }
+      z->frame += e.end-e.begin;
+      }
+    b->cursor = head;
+    }
+
+  for(auto& z:zones) {
+    z.samples[z.at] = z.frame;
+    z.at    = (z.at+1)%FrameHistory;
+    z.count = std::min(z.count+1,FrameHistory);
+    z.frame = 0;
+    }
+  }
+
+auto Profiler::stats() -> std::vector<Stat> {
+  std::lock_guard<std::mutex> guard(bufSync);
+  std::vector<Stat> ret;
+  uint64_t          s[FrameHistory] = {};
+  for(auto& z:zones) {
+    if(z.count==0)
+      continue;
+    std::copy(z.samples,z.samples+z.count,s);
+    std::sort(s,s+z.count);
+
+    uint64_t sum = 0;
+    for(size_t i=0; i<z.count; ++i)
+      sum += s[i];
+
+    Stat st;
+    st.name = z.name;
+    st.min  = double(s[0])/1e6;
+    st.avg  = double(sum)/double(z.count)/1e6;
+    st.p99  = double(s[(z.count*99)/100])/1e6;
+    ret.push_back(st);
+    }
+  return ret;
+  }
+
+bool Profiler::dumpTrace(std::string_view file) {
+  std::string        out = "{\"traceEvents\":[\n";
+  char               buf[256] = {};
+  bool               first    = true;
+  std::vector<Event> events;
+  {
+  std::lock_guard<std::mutex> guard(bufSync);
+  for(auto& b:buffers) {
+    // snapshot under lock, format without: owner thread is blocked only for a copy
+    events.clear();
+    {
+    std::lock_guard<std::mutex> g(b->sync);
+    const uint64_t head = b->head;
+    const uint64_t from = head>RingSize ? head-RingSize : 0;
+    for(uint64_t i=from; i<head; ++i)
+      events.push_back(b->ring[i%RingSize]);
+    }
+    for(auto& e:events) {
+      std::snprintf(buf,sizeof(buf),"%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",\n", e.name, b->tid, double(e.begin)/1000.0, double(e.end-e.begin)/1000.0);
+      out  += buf;
+      first = false;
+      }
+    }
+  }
+  out += "\n]}\n";
+
+  try {
+    WFile f{std::string(file)};
+    f.write(out.data(),out.size());
+    f.flush();
+    }
+  catch(...) {
+    Log::e("profiler: unable to write \"",file,"\"");
+    return false;
+    }
+  Log::i("profiler: trace written to \"",file,"\"");
+  return true;
+  }
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// scoped-zone cpu profiler: zones are written into per-thread ring buffers, while profiler is enabled.
+// Zones of same name should not nest - frame time of such zone is counted twice
+class Profiler final {
+  public:
+    class Zone final {
+      public:
+        explicit Zone(const char* name) {
+          if(!Profiler::enabled.load(std::memory_order_relaxed))
+            return;
+          this->name  = name;
+          this->begin = Profiler::now();
+          }
+        Zone(const Zone&) = delete;
+        ~Zone() {
+          if(name!=nullptr)
+            Profiler::push(name,begin,Profiler::now());
+          }
+        Zone& operator = (const Zone&) = delete;
+
+      private:
+        const char* name  = nullptr;
+        uint64_t    begin = 0;
+      };
+
+    struct Stat final {
+      std::string_view name;
+      double           min = 0; // milliseconds per frame
+      double           avg = 0;
+      double           p99 = 0;
+      };
+
+    static constexpr size_t FrameHistory = 128;
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool e);
+
+    // main thread, once per frame: zones since previous call are accounted as one frame
+    static void nextFrame();
+    // per-zone statistic of last FrameHistory frames
+    static auto stats() -> std::vector<Stat>;
+    // zones still in ring buffers, as chrome trace-event json
+    static bool dumpTrace(std::string_view file);
+
+  private:
+    static uint64_t now();
+    static void     push(const char* name, uint64_t begin, uint64_t end);
+
+    static inline std::atomic_bool enabled{false};
+  };
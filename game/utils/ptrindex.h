@@ -0,0 +1,60 @@
+#pragma once
+
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// pointer -> position index over an externally owned array.
+// Rebuilt lazily on first lookup after array was changed; a hit is always validated against the array,
+// so reordering, that was not reported with invalidate(), is detected as well.
+class PtrIndex final {
+  public:
+    PtrIndex() = default;
+    PtrIndex(const PtrIndex&) = delete;
+
+    void invalidate() { stale.store(true,std::memory_order_release); }
+
+    // at(i) must return key-pointer of i'th element of the array
+    template<class F>
+    uint32_t find(const void* ptr, size_t count, const F& at) const {
+      if(ptr==nullptr)
+        return uint32_t(-1);
+      {
+      std::shared_lock<std::shared_mutex> lck(sync);
+      if(!stale.load(std::memory_order_acquire) && count==builtCount) {
+        auto it = id.find(ptr);
+        if(it==id.end())
+          return uint32_t(-1);
+        if(it->second<count && at(it->second)==ptr)
+          return it->second;
+        }
+      }
+
+      std::unique_lock<std::shared_mutex> lck(sync);
+      if(!stale.load(std::memory_order_acquire) && count==builtCount) {
+        // rebuilt by other thread meanwhile
+        auto it = id.find(ptr);
+        if(it==id.end())
+          return uint32_t(-1);
+        if(it->second<count && at(it->second)==ptr)
+          return it->second;
+        }
+      stale.store(false,std::memory_order_release);
+      builtCount = count;
+      id.clear();
+      id.reserve(count);
+      for(size_t i=0; i<count; ++i)
+        id.emplace(at(i),uint32_t(i));
+      auto it = id.find(ptr);
+      return it!=id.end() ? it->second : uint32_t(-1);
+      }
+
+  private:
+    mutable std::shared_mutex                         sync;
+    mutable std::unordered_map<const void*,uint32_t> id;
+    mutable size_t                                    builtCount = 0;
+    mutable std::atomic<bool>                         stale{true};
+  };
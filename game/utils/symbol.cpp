@@ -0,0 +1,88 @@
+#include "symbol.h"
+
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <new>
+
+namespace {
+
+// names are never removed: id -> string is a chunked array, that is only appended to,
+// so readers don't need a lock to resolve an id
+class SymbolTable final {
+  public:
+    SymbolTable() {
+      chunk[0].reset(new std::string[ChunkSize]);
+      count.store(1);
+      }
+
+    uint32_t find(std::string_view str) const {
+      if(str.empty())
+        return 0;
+      std::shared_lock<std::shared_mutex> lck(sync);
+      auto it = index.find(str);
+      return it!=index.end() ? it->second : 0;
+      }
+
+    uint32_t intern(std::string_view str) {
+      if(str.empty())
+        return 0;
+      if(auto id = find(str))
+        return id;
+
+      std::unique_lock<std::shared_mutex> lck(sync);
+      auto it = index.find(str);
+      if(it!=index.end())
+        return it->second;
+
+      const uint32_t id = count.load(std::memory_order_relaxed);
+      if(id>=ChunkSize*ChunkCount)
+        throw std::bad_alloc();
+      auto&          ch = chunk[id/ChunkSize];
+      if(ch==nullptr)
+        ch.reset(new std::string[ChunkSize]);
+      ch[id%ChunkSize] = str;
+      index.emplace(std::string_view(ch[id%ChunkSize]), id);
+      count.store(id+1, std::memory_order_release);
+      return id;
+      }
+
+    std::string_view str(uint32_t id) const {
+      if(id==0 || id>=count.load(std::memory_order_acquire))
+        return "";
+      return chunk[id/ChunkSize][id%ChunkSize];
+      }
+
+  private:
+    static constexpr uint32_t ChunkSize  = 4096;
+    static constexpr uint32_t ChunkCount = 1024;
+
+    mutable std::shared_mutex                          sync;
+    std::unordered_map<std::string_view,uint32_t>      index;
+    std::unique_ptr<std::string[]>                     chunk[ChunkCount];
+    std::atomic<uint32_t>                              count{0};
+  };
+
+SymbolTable& table() {
+  static SymbolTable t;
+  return t;
+  }
+
+}
+
+Symbol::Symbol(std::string_view str)
+  :val(table().intern(str)) {
+  }
+
+Symbol Symbol::find(std::string_view str) {
+  Symbol ret;
+  ret.val = table().find(str);
+  return ret;
+  }
+
+std::string_view Symbol::str() const {
+  return table().str(val);
+  }
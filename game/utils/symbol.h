@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string_view>
+#include <functional>
+#include <cstdint>
+
+// interned string: compact id, that is stable for the lifetime of the process.
+// Interning takes a lock, lookups by id are lock-free; id 0 is the empty string.
+class Symbol final {
+  public:
+    constexpr Symbol() = default;
+    explicit Symbol(std::string_view str);
+
+    // lookup without interning: empty symbol, if string was never interned
+    static Symbol    find(std::string_view str);
+
+    std::string_view str()     const;
+    uint32_t         id()      const { return val;    }
+    bool             isEmpty() const { return val==0; }
+    explicit         operator bool() const { return val!=0; }
+
+    bool operator == (const Symbol& other) const { return val==other.val; }
+    bool operator != (const Symbol& other) const { return val!=other.val; }
+
+  private:
+    uint32_t val = 0;
+  };
+
+template<>
+struct std::hash<Symbol> {
+  size_t operator()(const Symbol& s) const noexcept { return s.id(); }
+  };
@@ -60,24 +60,29 @@ void Workers::setThreadName(const char* threadName) { (void)threadName; }
 
 using namespace Tempest;
 
-const size_t Workers::taskPerThread = 128;
-const size_t Workers::taskPerStep   = 16;
+const size_t        Workers::taskPerThread = 128;
+const size_t        Workers::taskPerStep   = 16;
+thread_local size_t Workers::queueId       = 0;
 
 Workers::Workers() {
-  size_t id=0;
-  for(auto& i:th) {
-    i = std::thread([this,id]() noexcept {
+  const size_t count = maxThreads()-1; // main thread also do tasks
+  queueCount = count+1;
+  queue.reset(new Queue[queueCount]);
+
+  th.resize(count);
+  for(size_t id=0; id<count; ++id) {
+    th[id] = std::thread([this,id]() noexcept {
       threadFunc(id);
       });
-    ++id;
     }
   }
 
 Workers::~Workers() {
-  running  = false;
-  workSet  = nullptr;
-  workSize = MAX_THREADS;
-  execWork(minWorkSize<void,void>());
+  {
+  std::unique_lock<std::mutex> lck(sleepSync);
+  running = false;
+  }
+  workWait.notify_all();
   for(auto& i:th)
     i.join();
   }
@@ -87,13 +92,30 @@ Workers &Workers::inst() {
   return w;
   }
 
-uint8_t Workers::maxThreads() {
+uint32_t Workers::maxThreads() {
   int32_t th = int32_t(std::thread::hardware_concurrency());
   if(th<=0)
     th = 1;
-  if(th>MAX_THREADS)
-    return MAX_THREADS;
-  return uint8_t(th);
+  return uint32_t(th);
+  }
+
+bool Workers::tryRunJob() {
+  auto& w = inst();
+  Job   job;
+  if(!w.tryPop(job))
+    return false;
+  w.exec(job);
+  return true;
+  }
+
+bool Workers::Task::isDone() const {
+  return state==nullptr || state->pending.load(std::memory_order_acquire)==0;
+  }
+
+void Workers::Task::wait() {
+  if(state==nullptr)
+    return;
+  inst().waitFor(*state);
   }
 
 void Workers::threadFunc(size_t id) {
@@ -101,99 +123,137 @@ void Workers::threadFunc(size_t id) {
   string_frm tname("Workers [",int(id),"]");
   setThreadName(tname.c_str());
   }
+  queueId = id+1;
 
   while(true) {
-    {
-    std::unique_lock<std::mutex> lck(sync);
-    workWait.wait(lck, [this]() { return workTbd>0; });
-    --workTbd;
-    }
-
-    if(!running) {
-      taskDone.fetch_add(1);
-      return;
-      }
-
-    if(workSet==nullptr) {
-      auto idx = progressIt.fetch_add(1);
-      workFunc(workSet+idx, 1);
-      } else {
-      taskLoop();
+    Job job;
+    if(tryPop(job)) {
+      exec(job);
+      continue;
       }
 
-    taskDone.fetch_add(1);
-    // if(size_t(taskDone.fetch_add(1)+1)==taskCount)
-    //   std::this_thread::yield();
+    std::unique_lock<std::mutex> lck(sleepSync);
+    workWait.wait(lck, [this]() { return !running || queued.load()>0; });
+    if(!running)
+      return;
     }
   }
 
-uint32_t Workers::taskLoop() {
-  uint32_t count = 0;
-  while(true) {
-    size_t b = size_t(progressIt.fetch_add(taskPerStep));
-    size_t e = std::min(b+taskPerStep, workSize);
-    if(e<=b)
-      break;
-
-    void* d = workSet + b*workEltSize;
-    workFunc(d,e-b);
-    count += uint32_t(e-b);
-    }
-  return count;
+void Workers::push(std::shared_ptr<Group> group, std::function<void()> func) {
+  group->pending.fetch_add(1);
+  {
+  auto& q = queue[queueId];
+  std::lock_guard<std::mutex> guard(q.sync);
+  q.jobs.push_back(Job{std::move(func),std::move(group)});
+  }
+  queued.fetch_add(1);
+  {
+  std::lock_guard<std::mutex> guard(sleepSync);
+  }
+  workWait.notify_one();
   }
 
-void Workers::execWork(uint32_t& minElts) {
-  if(workSize==0)
-    return;
+void Workers::push(const std::shared_ptr<Group>& group, const std::function<void()>& func, size_t count) {
+  group->pending.fetch_add(uint32_t(count));
+  {
+  auto& q = queue[queueId];
+  std::lock_guard<std::mutex> guard(q.sync);
+  for(size_t i=0; i<count; ++i)
+    q.jobs.push_back(Job{func,group});
+  }
+  queued.fetch_add(count);
+  {
+  std::lock_guard<std::mutex> guard(sleepSync);
+  }
+  if(count>1)
+    workWait.notify_all(); else
+    workWait.notify_one();
+  }
 
-  if(workSet!=nullptr) {
-    const auto maxTheads = maxThreads();
-    taskCount = uint32_t((workSize+taskPerThread-1)/taskPerThread);
-    taskCount--; // main thread also do tasks
-    if(taskCount>maxTheads)
-      taskCount = maxTheads;
-    if(taskCount<=0)
-      taskCount = 1;
-    } else {
-    taskCount = uint32_t(workSize);
-    }
+bool Workers::tryPop(Job& job) {
+  if(queued.load()==0)
+    return false;
 
-  if(running && taskCount==1) {
-    workFunc(workSet, workSize);
-    return;
+  {
+  // own queue: LIFO, to keep nested work hot in cache
+  auto& q = queue[queueId];
+  std::lock_guard<std::mutex> guard(q.sync);
+  if(!q.jobs.empty()) {
+    job = std::move(q.jobs.back());
+    q.jobs.pop_back();
+    queued.fetch_sub(1);
+    return true;
     }
+  }
 
-  minElts = std::max<uint32_t>(minElts, taskPerThread);
-
-  if(workSet!=nullptr && workSize<=minElts && true) {
-    workFunc(workSet, workSize);
-    if(minElts > workSize*2)
-      minElts = 0;
-    return;
+  // steal: FIFO, from the other end of victim queue
+  for(size_t i=1; i<queueCount; ++i) {
+    auto& q = queue[(queueId+i)%queueCount];
+    std::lock_guard<std::mutex> guard(q.sync);
+    if(!q.jobs.empty()) {
+      job = std::move(q.jobs.front());
+      q.jobs.pop_front();
+      queued.fetch_sub(1);
+      return true;
+      }
     }
+  return false;
+  }
 
-  progressIt.store(0);
-  taskDone.store(0);
+void Workers::exec(Job& job) {
+  try {
+    job.func();
+    }
+  catch(...) {
+    if(!job.group->hasError.test_and_set())
+      job.group->error = std::current_exception();
+    }
+  complete(*job.group);
+  }
 
+void Workers::complete(Group& g) {
+  if(g.pending.fetch_sub(1, std::memory_order_acq_rel)!=1)
+    return;
   {
-  std::unique_lock<std::mutex> lck(sync);
-  workTbd = int32_t(taskCount);
+  std::lock_guard<std::mutex> guard(doneSync);
+  }
+  doneWait.notify_all();
   }
-  workWait.notify_all();
 
-  uint32_t cnt = 0;
-  if(workSet==nullptr) {
-    std::this_thread::yield();
-    } else {
-    cnt = taskLoop(); (void)cnt;
+void Workers::waitFor(Group& g) {
+  while(g.pending.load(std::memory_order_acquire)>0) {
+    Job job;
+    if(tryPop(job)) {
+      exec(job);
+      continue;
+      }
+    // everything left in the group is already running on other threads
+    std::unique_lock<std::mutex> lck(doneSync);
+    doneWait.wait(lck, [&g]() { return g.pending.load(std::memory_order_acquire)==0; });
     }
 
-  while(true) {
-    int expect = int(taskCount);
-    if(taskDone.load()==expect) {
-      taskDone.store(0);
-      break;
-      }
-    std::this_thread::yield();
+  if(g.error!=nullptr)
+    std::rethrow_exception(g.error);
+  }
+
+void Workers::runShared(size_t count, const std::function<void()>& func) {
+  auto group = std::make_shared<Group>();
+  push(group,func,count-1);
+
+  try {
+    func();
     }
+  catch(...) {
+    if(!group->hasError.test_and_set())
+      group->error = std::current_exception();
+    }
+  // helper jobs reference caller stack - have to wait for them, even on error
+  waitFor(*group);
+  }
+
+size_t Workers::jobCount(size_t workSize, size_t minWorkSize) const {
+  if(workSize<=minWorkSize)
+    return 1;
+  size_t cnt = (workSize+minWorkSize-1)/minWorkSize;
+  return std::min(cnt, queueCount);
   }
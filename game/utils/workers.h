@@ -3,22 +3,80 @@
 #include <thread>
 #include <mutex>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
 #include <functional>
 #include <atomic>
 #include <algorithm>
 #include <condition_variable>
+#include <exception>
+#include <type_traits>
 #include <new>
 
 class Workers final {
+  private:
+    struct Group;
+    template<class R>
+    struct Result;
+
   public:
     Workers();
     ~Workers();
 
+    // handle to asynchronous work; wait() executes pending jobs, instead of blocking idle
+    class Task {
+      public:
+        Task() = default;
+
+        bool isValid() const { return state!=nullptr; }
+        bool isDone()  const;
+        void wait();
+
+      protected:
+        explicit Task(std::shared_ptr<Group> st):state(std::move(st)){}
+        std::shared_ptr<Group> state;
+
+      friend class Workers;
+      };
+
+    template<class R>
+    class Future : public Task {
+      public:
+        Future() = default;
+
+        R get() {
+          wait();
+          if constexpr(!std::is_void_v<R>) {
+            auto& r = static_cast<Result<R>&>(*state);
+            return std::move(*r.value);
+            }
+          }
+
+      private:
+        explicit Future(std::shared_ptr<Group> st):Task(std::move(st)){}
+
+      friend class Workers;
+      };
+
     static void setThreadName(const char* threadName);
 
+    template<class F>
+    static auto async(F func) -> Future<std::invoke_result_t<F&>> {
+      using R = std::invoke_result_t<F&>;
+      auto st  = std::make_shared<Result<R>>();
+      auto ptr = st.get();
+      inst().push(st, [ptr, func = std::move(func)]() mutable {
+        if constexpr(std::is_void_v<R>)
+          func(); else
+          ptr->value.emplace(func());
+        });
+      return Future<R>(std::move(st));
+      }
+
     template<class T,class F>
     static void parallelFor(T* b, T* e, const F& func) {
-      inst().runParallelFor(b,std::distance(b,e),func);
+      inst().runParallelFor(b,size_t(std::distance(b,e)),func);
       }
 
     template<class T,class F>
@@ -28,73 +86,112 @@ class Workers final {
 
     template<class T,class F>
     static void parallelTasks(std::vector<T>& data, const F& func) {
-      inst().runParallelFor(data.data(),data.size(),func);
+      T* ptr = data.data();
+      inst().runParallelTasks(data.size(),[ptr,&func](size_t id){ func(ptr[id]); });
       }
 
     template<class F>
     static void parallelTasks(size_t taskCount, const F& func) {
-      inst().runParallelTasks<F>(taskCount,func);
+      inst().runParallelTasks(taskCount,func);
       }
 
-    static uint8_t maxThreads();
+    static uint32_t maxThreads();
+    // executes one queued job on calling thread; false, if queues are empty
+    static bool     tryRunJob();
 
   private:
-    enum { MAX_THREADS=16 };
+    struct Group {
+      std::atomic<uint32_t> pending{0};
+      std::atomic_flag      hasError = ATOMIC_FLAG_INIT;
+      std::exception_ptr    error;
+      };
+
+    struct Job {
+      std::function<void()>  func;
+      std::shared_ptr<Group> group;
+      };
+
+    struct alignas(64) Queue {
+      std::mutex            sync;
+      std::deque<Job>       jobs;
+      };
 
     void            threadFunc(size_t id);
-    void            execWork(uint32_t& minWorkSize);
-    uint32_t        taskLoop();
+    void            push(std::shared_ptr<Group> group, std::function<void()> func);
+    void            push(const std::shared_ptr<Group>& group, const std::function<void()>& func, size_t count);
+    bool            tryPop(Job& job);
+    void            exec(Job& job);
+    void            complete(Group& g);
+    void            waitFor(Group& g);
+    void            runShared(size_t count, const std::function<void()>& func);
+    size_t          jobCount(size_t workSize, size_t minWorkSize) const;
     static Workers& inst();
 
-    template<class T,class F>
-    static uint32_t&  minWorkSize() {
-      static uint32_t data = 0;
-      return data;
-      }
-
-
     template<class T,class F>
     void runParallelFor(T* data, size_t sz, const F& func) {
-      workSet     = reinterpret_cast<uint8_t*>(data);
-      workSize    = sz;
-      workEltSize = sizeof(T);
-
-      workFunc = [&func](void* data, size_t sz) {
-        T* tdata = reinterpret_cast<T*>(data);
-        for(size_t i=0;i<sz;++i)
-          func(tdata[i]);
-        };
-
-      execWork(minWorkSize<T,F>());
+      const size_t jobs = jobCount(sz,taskPerThread);
+      if(jobs<=1) {
+        for(size_t i=0; i<sz; ++i)
+          func(data[i]);
+        return;
+        }
+
+      std::atomic<size_t> progressIt{0};
+      runShared(jobs,[&]() {
+        while(true) {
+          const size_t b = progressIt.fetch_add(taskPerStep);
+          if(b>=sz)
+            break;
+          const size_t e = std::min(b+taskPerStep, sz);
+          for(size_t i=b; i<e; ++i)
+            func(data[i]);
+          }
+        });
       }
 
     template<class F>
     void runParallelTasks(size_t taskCount, const F& func) {
-      workSet     = nullptr;
-      workSize    = taskCount;
-      workEltSize = 1;
-
-      workFunc = [&func](void* data, size_t sz) {
-        func(reinterpret_cast<uintptr_t>(data));
-        };
-      execWork(minWorkSize<void,F>());
+      const size_t jobs = jobCount(taskCount,1);
+      if(jobs<=1) {
+        for(size_t i=0; i<taskCount; ++i)
+          func(i);
+        return;
+        }
+
+      std::atomic<size_t> progressIt{0};
+      runShared(jobs,[&]() {
+        while(true) {
+          const size_t id = progressIt.fetch_add(1);
+          if(id>=taskCount)
+            break;
+          func(id);
+          }
+        });
       }
 
     static const size_t               taskPerThread;
     static const size_t               taskPerStep;
-    bool                              running=true;
+    static thread_local size_t        queueId;
 
-    std::thread                       th[MAX_THREADS];
+    bool                              running=true;
+    std::vector<std::thread>          th;
+    // queue[0] is shared by all non-worker threads
+    std::unique_ptr<Queue[]>          queue;
+    size_t                            queueCount = 0;
+    std::atomic<size_t>               queued{0};
 
-    std::mutex                        sync;
+    std::mutex                        sleepSync;
     std::condition_variable           workWait;
-    int32_t                           workTbd = 0;
 
-    uint8_t*                          workSet=nullptr;
-    size_t                            workSize=0, workEltSize=0;
-    std::function<void(void*,size_t)> workFunc;
+    std::mutex                        doneSync;
+    std::condition_variable           doneWait;
+  };
+
+template<class R>
+struct Workers::Result : Workers::Group {
+  std::optional<R> value;
+  };
 
-    std::atomic_int                   progressIt{0};
-    uint32_t                          taskCount = 0;
-    std::atomic_int                   taskDone{0};
+template<>
+struct Workers::Result<void> : Workers::Group {
   };
@@ -0,0 +1,28 @@
+#include "animationlod.h"
+
+#include <atomic>
+
+static std::atomic<uint8_t> lodPhase{0};
+
+AnimationLod::AnimationLod()
+  :phase(lodPhase.fetch_add(1,std::memory_order_relaxed)) {
+  }
+
+bool AnimationLod::update(Level lvl, uint64_t frame, uint64_t& dt) {
+  pendingDt += dt;
+  if(lvl==Frozen && !force) {
+    prev = lvl;
+    return false;
+    }
+
+  // stagger objects with same level across frames, to keep per-frame cost flat
+  const bool upd = force || lvl==Full || prev==Frozen || prev>lvl || ((frame+phase)%lvl)==0;
+  prev = lvl;
+  if(!upd)
+    return false;
+
+  dt        = pendingDt;
+  pendingDt = 0;
+  force     = false;
+  return true;
+  }
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// Update-rate throttling for skeletal animation: distant and off-screen objects reevaluate pose
+// only every N-th frame. Time of skipped frames is accumulated and handed over on next update.
+class AnimationLod final {
+  public:
+    AnimationLod();
+
+    enum Level : uint8_t {
+      Frozen  = 0,
+      Full    = 1,
+      Half    = 2,
+      Quarter = 4,
+      };
+
+    // returns true, if pose has to be updated in this frame; dt is replaced with accumulated time
+    bool update(Level lvl, uint64_t frame, uint64_t& dt);
+    void invalidate() { force = true; }
+
+    Level level() const { return prev; }
+
+  private:
+    uint64_t pendingDt = 0;
+    uint8_t  phase     = 0;
+    Level    prev      = Full;
+    bool     force     = true;
+  };
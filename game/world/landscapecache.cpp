@@ -0,0 +1,247 @@
+#include "landscapecache.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <filesystem>
+#include <cstring>
+#include <type_traits>
+#include <miniz.h>
+
+#include "graphics/mesh/submesh/packedmesh.h"
+#include "physics/physics.h"
+#include "utils/mappedfile.h"
+
+using namespace Tempest;
+
+struct LandscapeCache::Header {
+  char     magic[4] = {'O','G','L','C'};
+  uint32_t version  = LandscapeCache::version;
+  uint64_t key      = 0;
+  uint64_t size     = 0; // payload size
+  uint32_t crc      = 0; // payload crc32
+  uint32_t padding  = 0;
+  };
+
+namespace {
+
+struct Writer {
+  std::vector<uint8_t>& out;
+
+  void put(const void* data, size_t size) {
+    auto ptr = reinterpret_cast<const uint8_t*>(data);
+    out.insert(out.end(),ptr,ptr+size);
+    }
+
+  template<class T>
+  void put(const T& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    put(&v,sizeof(v));
+    }
+
+  template<class T>
+  void put(const std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    put(uint64_t(v.size()));
+    put(v.data(),v.size()*sizeof(T));
+    }
+  };
+
+struct Reader {
+  const uint8_t* at;
+  const uint8_t* end;
+
+  bool get(void* data, size_t size) {
+    if(size_t(end-at)<size)
+      return false;
+    std::memcpy(data,at,size);
+    at += size;
+    return true;
+    }
+
+  template<class T>
+  bool get(T& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return get(&v,sizeof(v));
+    }
+
+  template<class T>
+  bool get(std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint64_t sz = 0;
+    if(!get(sz) || sz>size_t(end-at)/sizeof(T))
+      return false;
+    v.resize(size_t(sz));
+    return get(v.data(),v.size()*sizeof(T));
+    }
+  };
+
+}
+
+LandscapeCache::LandscapeCache(std::string_view world, zenkit::Read& zen)
+  :world(world) {
+  // content hash: crc32 of zen-file and it's size
+  std::vector<uint8_t> chunk(1024*1024);
+  mz_ulong crc  = mz_crc32(0,nullptr,0);
+  uint64_t size = 0;
+  zen.seek(0, zenkit::Whence::BEG);
+  while(true) {
+    size_t n = zen.read(chunk.data(),chunk.size());
+    if(n==0)
+      break;
+    crc   = mz_crc32(crc,chunk.data(),n);
+    size += n;
+    }
+  zen.seek(0, zenkit::Whence::BEG);
+  key = (size<<32) ^ uint64_t(crc);
+  }
+
+std::string LandscapeCache::path(std::string_view tag) const {
+  return "cache/" + world + "." + std::string(tag);
+  }
+
+bool LandscapeCache::write(std::string_view tag, const std::vector<uint8_t>& data) const {
+  if(world.empty())
+    return false;
+
+  Header h;
+  h.key  = key;
+  h.size = data.size();
+  h.crc  = uint32_t(mz_crc32(mz_crc32(0,nullptr,0),data.data(),data.size()));
+
+  // write to temporary file first: other process may have the cache mapped
+  const std::string dst = path(tag);
+  const std::string tmp = dst + ".tmp";
+  try {
+    std::error_code ec;
+    std::filesystem::create_directories("cache",ec);
+    {
+    WFile f(tmp);
+    f.write(&h,sizeof(h));
+    f.write(data.data(),data.size());
+    f.flush();
+    }
+    std::filesystem::rename(tmp,dst,ec);
+    if(ec) {
+      std::filesystem::remove(tmp,ec);
+      return false;
+      }
+    return true;
+    }
+  catch(...) {
+    Log::e("unable to write landscape cache: \"",dst,"\"");
+    return false;
+    }
+  }
+
+const uint8_t* LandscapeCache::payload(const MappedFile& file, size_t& size) const {
+  Header h;
+  if(file.size()<sizeof(h))
+    return nullptr;
+  std::memcpy(&h,file.data(),sizeof(h));
+  if(std::memcmp(h.magic,"OGLC",4)!=0 || h.version!=version || h.key!=key)
+    return nullptr;
+  if(h.size!=file.size()-sizeof(h))
+    return nullptr;
+
+  const uint8_t* data = file.data()+sizeof(h);
+  if(uint32_t(mz_crc32(mz_crc32(0,nullptr,0),data,size_t(h.size)))!=h.crc)
+    return nullptr;
+  size = size_t(h.size);
+  return data;
+  }
+
+bool LandscapeCache::loadMesh(PackedMesh& out, const zenkit::Mesh& mesh) const {
+  if(world.empty())
+    return false;
+
+  MappedFile file(path("mesh"));
+  size_t     size = 0;
+  auto       data = payload(file,size);
+  if(data==nullptr)
+    return false;
+
+  Reader   rd = {data,data+size};
+  uint8_t  alphaTest = 0;
+  uint64_t subCount  = 0;
+  float    bbox[6]   = {};
+  bool ok = rd.get(bbox) && rd.get(alphaTest) &&
+            rd.get(out.vertices) && rd.get(out.indices) && rd.get(out.indices8) && rd.get(out.meshletBounds) &&
+            rd.get(subCount) && subCount<=size;
+  if(!ok)
+    return false;
+
+  out.mBbox[0]         = Vec3(bbox[0],bbox[1],bbox[2]);
+  out.mBbox[1]         = Vec3(bbox[3],bbox[4],bbox[5]);
+  out.isUsingAlphaTest = (alphaTest!=0);
+  out.subMeshes.resize(size_t(subCount));
+  for(auto& sm:out.subMeshes) {
+    uint64_t off = 0, len = 0;
+    if(!rd.get(sm.materialId) || !rd.get(off) || !rd.get(len))
+      return false;
+    if(sm.materialId>=mesh.materials.size() || off+len>out.indices.size())
+      return false;
+    sm.material  = mesh.materials[sm.materialId];
+    sm.iboOffset = size_t(off);
+    sm.iboLength = size_t(len);
+    }
+  return rd.at==rd.end;
+  }
+
+void LandscapeCache::saveMesh(const PackedMesh& pkg) const {
+  std::vector<uint8_t> data;
+  Writer wr = {data};
+  const float bbox[6] = {pkg.mBbox[0].x, pkg.mBbox[0].y, pkg.mBbox[0].z,
+                         pkg.mBbox[1].x, pkg.mBbox[1].y, pkg.mBbox[1].z};
+  wr.put(bbox);
+  wr.put(uint8_t(pkg.isUsingAlphaTest ? 1 : 0));
+  wr.put(pkg.vertices);
+  wr.put(pkg.indices);
+  wr.put(pkg.indices8);
+  wr.put(pkg.meshletBounds);
+  wr.put(uint64_t(pkg.subMeshes.size()));
+  for(auto& sm:pkg.subMeshes) {
+    wr.put(sm.materialId);
+    wr.put(uint64_t(sm.iboOffset));
+    wr.put(uint64_t(sm.iboLength));
+    }
+  write("mesh",data);
+  }
+
+LandscapeCache::BvhData LandscapeCache::loadBvh(std::string_view tag, btBvhTriangleMeshShape& shape) const {
+  BvhData ret(nullptr,[](void* p){ btAlignedFree(p); });
+  if(world.empty())
+    return ret;
+
+  MappedFile file(path(tag));
+  size_t     size = 0;
+  auto       data = payload(file,size);
+  if(data==nullptr || size==0)
+    return ret;
+
+  // NOTE: deSerializeInPlace patches pointers inside of the buffer: need a writable, aligned copy
+  ret.reset(btAlignedAlloc(size,16));
+  std::memcpy(ret.get(),data,size);
+  auto bvh = btOptimizedBvh::deSerializeInPlace(ret.get(),unsigned(size),false);
+  if(bvh==nullptr) {
+    ret.reset();
+    return ret;
+    }
+  shape.setOptimizedBvh(bvh);
+  return ret;
+  }
+
+void LandscapeCache::saveBvh(std::string_view tag, const btBvhTriangleMeshShape& shape) const {
+  auto bvh = const_cast<btBvhTriangleMeshShape&>(shape).getOptimizedBvh();
+  if(bvh==nullptr || world.empty())
+    return;
+
+  const unsigned size = bvh->calculateSerializeBufferSize();
+  auto buf = BvhData(btAlignedAlloc(size,16),[](void* p){ btAlignedFree(p); });
+  if(!bvh->serializeInPlace(buf.get(),size,false))
+    return;
+
+  std::vector<uint8_t> data(reinterpret_cast<const uint8_t*>(buf.get()),
+                            reinterpret_cast<const uint8_t*>(buf.get())+size);
+  write(tag,data);
+  }
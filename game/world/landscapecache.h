@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <zenkit/Stream.hh>
+#include <zenkit/Mesh.hh>
+
+class PackedMesh;
+class MappedFile;
+class btBvhTriangleMeshShape;
+
+// Persistent on-disk cache of data derived from landscape mesh: packed visual meshlets and collision bvh.
+// Entries are keyed by content hash of the zen-file and validated with crc; on any mismatch caller rebuilds.
+class LandscapeCache final {
+  public:
+    LandscapeCache(std::string_view world, zenkit::Read& zen);
+
+    using BvhData = std::unique_ptr<void,void(*)(void*)>;
+
+    bool    loadMesh(PackedMesh& out, const zenkit::Mesh& mesh) const;
+    void    saveMesh(const PackedMesh& pkg) const;
+
+    // bvh is deserialized in place: returned buffer must outlive the shape
+    BvhData loadBvh(std::string_view tag, btBvhTriangleMeshShape& shape) const;
+    void    saveBvh(std::string_view tag, const btBvhTriangleMeshShape& shape) const;
+
+  private:
+    // bump, when output of mesh packing or bvh layout changes
+    static constexpr uint32_t version = 2;
+
+    struct Header;
+
+    std::string    path(std::string_view tag) const;
+    const uint8_t* payload(const MappedFile& file, size_t& size) const;
+    bool           write(std::string_view tag, const std::vector<uint8_t>& data) const;
+
+    std::string world;
+    uint64_t    key = 0;
+  };
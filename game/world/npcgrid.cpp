@@ -0,0 +1,113 @@
+#include "npcgrid.h"
+
+#include <cmath>
+
+#include "world/objects/npc.h"
+
+using namespace Tempest;
+
+const float NpcGrid::cellSize = 2000.f;
+
+NpcGrid::~NpcGrid() {
+  clear();
+  }
+
+void NpcGrid::clear() {
+  for(auto& c:cells)
+    for(auto npc:c.second)
+      npc->gridNode = Node();
+  cells.clear();
+  count = 0;
+  }
+
+void NpcGrid::insert(Npc& npc) {
+  if(npc.gridNode.grid==this)
+    return;
+  if(npc.gridNode.grid!=nullptr)
+    npc.gridNode.grid->erase(npc);
+  attach(npc,cellKey(npc.position()));
+  ++count;
+  }
+
+void NpcGrid::erase(Npc& npc) {
+  if(npc.gridNode.grid!=this)
+    return;
+  detach(npc);
+  npc.gridNode = Node();
+  --count;
+  }
+
+void NpcGrid::move(Npc& npc) {
+  if(npc.gridNode.grid!=this)
+    return;
+  const uint64_t key = cellKey(npc.position());
+  if(key==npc.gridNode.cell)
+    return;
+  detach(npc);
+  attach(npc,key);
+  }
+
+int32_t NpcGrid::cellCoord(float v) {
+  return int32_t(std::floor(v/cellSize));
+  }
+
+uint64_t NpcGrid::cellKey(int32_t x, int32_t z) {
+  return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(z));
+  }
+
+uint64_t NpcGrid::cellKey(const Vec3& p) {
+  return cellKey(cellCoord(p.x),cellCoord(p.z));
+  }
+
+void NpcGrid::detach(Npc& npc) {
+  auto it = cells.find(npc.gridNode.cell);
+  if(it==cells.end())
+    return;
+  auto& c = it->second;
+  auto  s = npc.gridNode.slot;
+  c[s] = c.back();
+  c[s]->gridNode.slot = s;
+  c.pop_back();
+  if(c.empty())
+    cells.erase(it);
+  }
+
+void NpcGrid::attach(Npc& npc, uint64_t key) {
+  auto& c = cells[key];
+  npc.gridNode.grid = this;
+  npc.gridNode.cell = key;
+  npc.gridNode.slot = c.size();
+  c.push_back(&npc);
+  }
+
+void NpcGrid::implFind(const Vec3& p, float R, const void* ctx, void (*func)(const void*, Npc&)) const {
+  const float   qR = R*R;
+  const int32_t x0 = cellCoord(p.x-R), x1 = cellCoord(p.x+R);
+  const int32_t z0 = cellCoord(p.z-R), z1 = cellCoord(p.z+R);
+
+  // callback is allowed to move npc's, so collect first
+  std::vector<Npc*> ret;
+  const uint64_t area = uint64_t(x1-x0+1)*uint64_t(z1-z0+1);
+  if(area>=cells.size()) {
+    // large radius - faster to visit every populated cell
+    for(auto& c:cells)
+      collect(ret,c.second,p,qR);
+    } else {
+    for(int32_t x=x0; x<=x1; ++x)
+      for(int32_t z=z0; z<=z1; ++z) {
+        auto it = cells.find(cellKey(x,z));
+        if(it!=cells.end())
+          collect(ret,it->second,p,qR);
+        }
+    }
+
+  for(auto npc:ret)
+    func(ctx,*npc);
+  }
+
+void NpcGrid::collect(std::vector<Npc*>& ret, const std::vector<Npc*>& cell, const Vec3& p, float qR) {
+  for(auto npc:cell) {
+    if((npc->position()-p).quadLength()<qR)
+      ret.push_back(npc);
+    }
+  }
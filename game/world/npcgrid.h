@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <Tempest/Point>
+
+class Npc;
+
+// Loose hash-grid over XZ plane for moving npc's. Updated incrementally, on every position change
+class NpcGrid final {
+  public:
+    NpcGrid() = default;
+    NpcGrid(const NpcGrid&) = delete;
+    ~NpcGrid();
+
+    struct Node {
+      NpcGrid* grid = nullptr;
+      uint64_t cell = 0;
+      size_t   slot = 0;
+      };
+
+    void   clear();
+    void   insert(Npc& npc);
+    void   erase (Npc& npc);
+    void   move  (Npc& npc);
+    size_t size() const { return count; }
+
+    template<class Func>
+    void find(const Tempest::Vec3& p, float R, const Func& f) const {
+      implFind(p,R,&f,[](const void* ctx, Npc& npc){
+        auto& f = *reinterpret_cast<const Func*>(ctx);
+        f(npc);
+        });
+      }
+
+  private:
+    static const float cellSize;
+
+    static int32_t  cellCoord(float v);
+    static uint64_t cellKey(int32_t x, int32_t z);
+    static uint64_t cellKey(const Tempest::Vec3& p);
+
+    void            implFind(const Tempest::Vec3& p, float R, const void* ctx, void (*func)(const void*, Npc&)) const;
+    static void     collect(std::vector<Npc*>& ret, const std::vector<Npc*>& cell, const Tempest::Vec3& p, float qR);
+    void            detach(Npc& npc);
+    void            attach(Npc& npc, uint64_t cell);
+
+    std::unordered_map<uint64_t,std::vector<Npc*>> cells;
+    size_t                                         count = 0;
+  };
@@ -204,6 +204,13 @@ void Interactive::setVisual(const zenkit::VirtualObject& vob) {
   }
 
 void Interactive::updateAnimation(uint64_t dt) {
+  animLod.invalidate();
+  updateAnimation(dt,AnimationLod::Full,0);
+  }
+
+void Interactive::updateAnimation(uint64_t dt, AnimationLod::Level lod, uint64_t frame) {
+  if(!animLod.update(lod,frame,dt))
+    return;
   if(visual.updateAnimation(nullptr,world,dt))
     animChanged = true;
   }
@@ -919,6 +926,7 @@ const Animation::Sequence* Interactive::setAnim(Interactive::Anim t) {
     std::snprintf(buf,sizeof(buf),"S_%s",ss[0]); else
     std::snprintf(buf,sizeof(buf),"T_%s_2_%s",ss[0],ss[1]);
 
+  animLod.invalidate();
   return visual.startAnimAndGet(buf,world.tickCount());
   }
 
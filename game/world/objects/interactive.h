@@ -7,6 +7,7 @@
 #include "graphics/mesh/animationsolver.h"
 #include "graphics/objvisual.h"
 #include "world/triggers/abstracttrigger.h"
+#include "world/animationlod.h"
 #include "game/inventory.h"
 #include "utils/keycodec.h"
 #include "vob.h"
@@ -34,6 +35,7 @@ class Interactive : public Vob {
 
     void                resetPositionToTA(int32_t state);
     void                updateAnimation(uint64_t dt);
+    void                updateAnimation(uint64_t dt, AnimationLod::Level lod, uint64_t frame);
     void                tick(uint64_t dt);
     void                onKeyInput(KeyCodec::Action act);
 
@@ -173,4 +175,5 @@ class Interactive : public Vob {
     PhysicMesh          physic;
 
     ObjVisual           visual;
+    AnimationLod        animLod;
   };
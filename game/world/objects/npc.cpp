@@ -180,6 +180,8 @@ Npc::Npc(World &owner, size_t instance, std::string_view waypoint)
 Npc::~Npc(){
   if(currentInteract)
     currentInteract->detach(*this,true);
+  if(gridNode.grid!=nullptr)
+    gridNode.grid->erase(*this);
   }
 
 void Npc::save(Serialize &fout, size_t id) {
@@ -370,6 +372,8 @@ bool Npc::setPosition(float ix, float iy, float iz) {
   z = iz;
   durtyTranform |= TR_Pos;
   physic.setPosition(Vec3{x,y,z});
+  if(gridNode.grid!=nullptr)
+    gridNode.grid->move(*this);
   return true;
   }
 
@@ -382,6 +386,8 @@ void Npc::setViewPosition(const Tempest::Vec3& pos) {
   y = pos.y;
   z = pos.z;
   durtyTranform |= TR_Pos;
+  if(gridNode.grid!=nullptr)
+    gridNode.grid->move(*this);
   }
 
 int Npc::aiOutputOrderId() const {
@@ -1944,7 +1950,7 @@ Npc *Npc::updateNearestEnemy() {
     dist = qDistTo(*ret);
     }
 
-  owner.detectNpcNear([this,&ret,&dist](Npc& n){
+  owner.detectNpc(position(),float(hnpc->senses_range),[this,&ret,&dist](Npc& n){
     if(!isEnemy(n) || n.isDown() || &n==this)
       return;
 
@@ -1965,7 +1971,7 @@ Npc* Npc::updateNearestBody() {
   Npc*  ret  = nullptr;
   float dist = std::numeric_limits<float>::max();
 
-  owner.detectNpcNear([this,&ret,&dist](Npc& n){
+  owner.detectNpc(position(),float(hnpc->senses_range),[this,&ret,&dist](Npc& n){
     if(!n.isDead())
       return;
 
@@ -4213,6 +4219,17 @@ bool Npc::canSeeNpc(const Vec3 pos, bool freeLos) const {
   return canRayHitPoint(pos, freeLos);
   }
 
+// line of sight: same rays are cast by perception and then by perception scripts within a tick
+static DynamicWorld::RayQueryResult losRay(const DynamicWorld& w, const Vec3& from, const Vec3& to) {
+  static thread_local DynamicWorld::RayBatch rays;
+  rays.clear();
+  rays.useCache  = true;
+  rays.syncAabbs = false; // same as ray()
+  rays.add(from,to);
+  w.rayBatch(rays);
+  return rays.result(0);
+  }
+
 bool Npc::canRayHitPoint(const Tempest::Vec3 pos, bool freeLos, float extRange) const {
   const float range = float(hnpc->senses_range) + extRange;
   if(qDistTo(pos)>range*range)
@@ -4223,14 +4240,14 @@ bool Npc::canRayHitPoint(const Tempest::Vec3 pos, bool freeLos, float extRange)
   // npc eyesight height
   auto head = visual.mapHeadBone();
   if(freeLos) {
-    return !w->ray(head, pos).hasCol;
+    return !losRay(*w,head,pos).hasCol;
     }
 
   float dx  = x-pos.x, dz=z-pos.z;
   float dir = angleDir(dx,dz);
   float da  = float(M_PI)*(visual.viewDirection()-dir)/180.f;
   if(double(std::cos(da))<=ref) {
-    if(!w->ray(head, pos).hasCol)
+    if(!losRay(*w,head,pos).hasCol)
       return true;
     }
   return false;
@@ -4283,14 +4300,14 @@ bool Npc::canSeeItem(const Item& it, bool freeLos) const {
 
   // npc eyesight height
   auto head = visual.mapHeadBone();
-  auto r    = w->ray(head,itMid);
+  auto r    = losRay(*w,head,itMid);
   auto err  = (head-itMid)*(1.f-r.hitFraction);
   if(!r.hasCol || err.length()<25.f) {
     return true;
     }
   if(y<=itMid.y && itMid.y<=head.y) {
     auto pl = Vec3(head.x,itMid.y,head.z);
-    r   = w->ray(pl,itMid);
+    r   = losRay(*w,pl,itMid);
     err = (pl-itMid)*(1.f-r.hitFraction);
     if(!r.hasCol || err.length()<65.f)
       return true;
@@ -4347,10 +4364,16 @@ void Npc::updateTransform() {
   }
 
 void Npc::updateAnimation(uint64_t dt) {
+  animLod.invalidate();
+  updateAnimation(dt,AnimationLod::Full,0);
+  }
+
+void Npc::updateAnimation(uint64_t dt, AnimationLod::Level lod, uint64_t frame) {
   const auto camera = Gothic::inst().camera();
   if(isPlayer() && camera!=nullptr && camera->isFree())
     dt = 0;
 
+  const bool moved = (durtyTranform!=0);
   if(durtyTranform) {
     const auto ground = groundNormal();
     if(lastGroundNormal!=ground) {
@@ -4379,6 +4402,13 @@ void Npc::updateAnimation(uint64_t dt) {
     durtyTranform = 0;
     }
 
+  if(!animLod.update(lod,frame,dt)) {
+    // pose is kept from last update, but attachments must follow the body
+    if(moved)
+      visual.syncAttaches();
+    return;
+    }
+
   bool syncAtt = visual.updateAnimation(this,owner,dt);
   if(syncAtt)
     visual.syncAttaches();
@@ -11,7 +11,9 @@
 #include "game/gamescript.h"
 #include "physics/dynamicworld.h"
 #include "world/aiqueue.h"
+#include "world/animationlod.h"
 #include "world/fplock.h"
+#include "world/npcgrid.h"
 #include "world/waypath.h"
 
 #include <cstdint>
@@ -131,6 +133,7 @@ class Npc final {
     float      qDistTo(const Item& p) const;
 
     void       updateAnimation(uint64_t dt);
+    void       updateAnimation(uint64_t dt, AnimationLod::Level lod, uint64_t frame);
     void       updateTransform();
 
     std::string_view displayName() const;
@@ -529,12 +532,14 @@ class Npc final {
     int32_t                        bdColor = 0;
     float                          bdFatness = 0;
     MdlVisual                      visual;
+    AnimationLod                   animLod;
 
     // visual props (cache)
     uint8_t                        durtyTranform=0;
     Tempest::Vec3                  lastGroundNormal;
 
     DynamicWorld::NpcItem          physic;
+    NpcGrid::Node                  gridNode;
 
     WalkBit                        wlkMode                 =WalkBit::WM_Run;
     int32_t                        trGuild                 =GIL_NONE;
@@ -614,4 +619,5 @@ class Npc final {
     Sound                          sfxWeapon;
 
   friend class MoveAlgo;
+  friend class NpcGrid;
   };
@@ -4,7 +4,8 @@
 #include "resources.h"
 
 VobBundle::VobBundle(World& owner, std::string_view filename, Vob::Flags flags) {
-  auto* bundle = Resources::loadVobBundle(filename);
+  // bundle is only needed to spawn vobs, let cache evict it later
+  auto bundle = Resources::acquireVobBundle(filename);
   for(auto& vob:*bundle)
     rootVobs.emplace_back(Vob::load(nullptr,owner,*vob,(flags | Vob::Startup)));
   }
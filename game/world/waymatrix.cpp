@@ -3,6 +3,7 @@
 #include <Tempest/Log>
 #include <algorithm>
 #include <limits>
+#include <cmath>
 
 #include "utils/dbgpainter.h"
 #include "utils/versioninfo.h"
@@ -11,6 +12,14 @@
 
 using namespace Tempest;
 
+static float component(const Vec3& v, uint8_t axis) {
+  switch(axis) {
+    case 0: return v.x;
+    case 1: return v.y;
+    }
+  return v.z;
+  }
+
 WayMatrix::WayMatrix(World &world, const zenkit::WayNet& dat)
   :world(world) {
   // scripting doc says 20m, but number seems to be incorrect
@@ -26,8 +35,6 @@ WayMatrix::WayMatrix(World &world, const zenkit::WayNet& dat)
     }
 
   edges = dat.edges;
-  stk[0].reserve(256);
-  stk[1].reserve(256);
   }
 
 void WayMatrix::buildIndex() {
@@ -39,12 +46,20 @@ void WayMatrix::buildIndex() {
     return a->name<b->name;
     });
 
-  for(auto& i:freePoints)
-    fpInd.push_back(&i);
-
-  std::sort(fpInd.begin(),fpInd.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->x<b->x;
-    });
+  {
+    std::vector<const WayPoint*> pt(indexPoints.begin(),indexPoints.end());
+    indexTree.build(std::move(pt));
+  }
+  {
+    std::vector<const WayPoint*> pt;
+    for(auto& i:wayPoints)
+      pt.push_back(&i);
+    wayTree.build(std::move(pt));
+  }
+  {
+    std::unique_lock<std::shared_mutex> guard(fpSync);
+    fpIndex.clear();
+  }
 
   for(auto& i:edges) {
     if(i.a<wayPoints.size() && i.b<wayPoints.size()) {
@@ -56,24 +71,19 @@ void WayMatrix::buildIndex() {
       }
     }
 
+  // edge length is truncated: floor(d) >= d*(1-1/minLen), so scaled distance never overestimates path length
+  int32_t minLen = std::numeric_limits<int32_t>::max();
+  for(auto& i:wayPoints)
+    for(auto& c:i.connections())
+      minLen = std::min(minLen,c.len);
+  heuristicScale = minLen>1 ? 1.f - 1.f/float(minLen) : 0.f;
+
   calculateLadderPoints();
+  invalidatePathCache();
   }
 
 const WayPoint *WayMatrix::findWayPoint(const Vec3& at, const std::function<bool(const WayPoint&)>& filter) const {
-  const WayPoint* ret =nullptr;
-  float           dist=std::numeric_limits<float>::max();
-  for(auto& w:wayPoints) {
-    if(!filter(w))
-      continue;
-    auto  dp0 = at-w.position();
-    float l0  = dp0.quadLength();
-
-    if(l0<dist){
-      ret  = &w;
-      dist = l0;
-      }
-    }
-  return ret;
+  return wayTree.nearest(at,std::numeric_limits<float>::max(),filter);
   }
 
 const WayPoint *WayMatrix::findFreePoint(const Vec3& at, std::string_view name, const std::function<bool(const WayPoint&)>& filter) const {
@@ -82,21 +92,10 @@ const WayPoint *WayMatrix::findFreePoint(const Vec3& at, std::string_view name,
   }
 
 const WayPoint *WayMatrix::findNextPoint(const Vec3& at) const {
-  const WayPoint* ret   = nullptr;
-  float           dist  = distanceThreshold;
-
-  dist*=dist;
-  for(auto pw:indexPoints){
-    auto& w  = *pw;
-    auto  dp = w.position()-at;
-    float l  = dp.quadLength();
-
-    if(l<dist && dp.z*dp.z<300*300 && !w.isLocked()){
-      ret  = &w;
-      dist = l;
-      }
-    }
-  return ret;
+  return indexTree.nearest(at,distanceThreshold,[&at](const WayPoint& w){
+    const float dz = w.z-at.z;
+    return dz*dz<300*300 && !w.isLocked();
+    });
   }
 
 void WayMatrix::addFreePoint(const Vec3& pos, const Vec3& dir, std::string_view name) {
@@ -184,10 +183,15 @@ void WayMatrix::marchPoints(DbgPainter &p) const {
   }
 
 void WayMatrix::adjustWaypoints(std::vector<WayPoint> &wp) {
-  for(auto& w:wp) {
-    auto ray = world.physic()->landRay(w.position());
-    if(ray.hasCol)
-      w.y = ray.v.y;
+  DynamicWorld::RayBatch rays;
+  for(auto& w:wp)
+    rays.addLand(w.position());
+  world.physic()->rayBatch(rays);
+
+  for(size_t i=0; i<wp.size(); ++i) {
+    auto& w = wp[i];
+    if(rays.hasCol[i])
+      w.y = rays.hitPos[i].y;
     indexPoints.push_back(&w);
     }
   }
@@ -230,64 +234,229 @@ void WayMatrix::calculateLadderPoints() {
   }
 
 const WayMatrix::FpIndex &WayMatrix::findFpIndex(std::string_view name) const {
-  auto it = std::lower_bound(fpIndex.begin(),fpIndex.end(),name,[](FpIndex& l, std::string_view r){
-    return l.key<r;
-    });
-  if(it!=fpIndex.end() && it->key==name){
-    return *it;
-    }
+  auto lowerBound = [this](std::string_view name) {
+    return std::lower_bound(fpIndex.begin(),fpIndex.end(),name,[](const std::unique_ptr<FpIndex>& l, std::string_view r){
+      return l->key<r;
+      });
+    };
+
+  {
+    std::shared_lock<std::shared_mutex> guard(fpSync);
+    auto it = lowerBound(name);
+    if(it!=fpIndex.end() && (*it)->key==name)
+      return **it;
+  }
+
+  std::unique_lock<std::shared_mutex> guard(fpSync);
+  auto it = lowerBound(name);
+  if(it!=fpIndex.end() && (*it)->key==name)
+    return **it;
 
-  FpIndex id;
-  id.key = name;
+  auto id = std::make_unique<FpIndex>();
+  id->key = name;
+  std::vector<const WayPoint*> pt;
   for(auto& w:freePoints){
     if(!w.checkName(name))
       continue;
-    id.index.push_back(&w);
+    pt.push_back(&w);
     }
-  // TODO: good index, not sort by 'x' :)
-  std::sort(id.index.begin(),id.index.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->x<b->x;
-    });
+  id->index.build(std::move(pt));
 
   it = fpIndex.insert(it,std::move(id));
-  return *it;
+  return **it;
   }
 
 const WayPoint *WayMatrix::findFreePoint(float x, float y, float z, const FpIndex& ind,
                                          const std::function<bool(const WayPoint&)>& filter) const {
-  float R = distanceThreshold;
-  auto b = std::lower_bound(ind.index.begin(),ind.index.end(), x-R ,[](const WayPoint *a, float b){
-    return a->x<b;
+  return ind.index.nearest(Vec3(x,y,z),distanceThreshold,[z,&filter](const WayPoint& w){
+    const float dz = w.z-z;
+    if(dz*dz>300*300)
+      return false;
+    return filter(w);
     });
-  auto e = std::upper_bound(ind.index.begin(),ind.index.end(), x+R ,[](float a,const WayPoint *b){
-    return a<b->x;
+  }
+
+void WayMatrix::KdTree::build(std::vector<const WayPoint*>&& pt) {
+  points = std::move(pt);
+  build(points.data(),points.size(),0);
+  }
+
+void WayMatrix::KdTree::build(const WayPoint** v, size_t cnt, uint8_t axis) {
+  if(cnt<=1)
+    return;
+  const size_t mid = cnt/2;
+  std::nth_element(v,v+mid,v+cnt,[axis](const WayPoint* a, const WayPoint* b){
+    return component(a->position(),axis) < component(b->position(),axis);
     });
+  const uint8_t next = uint8_t((axis+1)%3);
+  build(v,mid,next);
+  build(v+mid+1,cnt-mid-1,next);
+  }
+
+const WayPoint* WayMatrix::KdTree::nearest(const Vec3& at, float maxDist, const std::function<bool(const WayPoint&)>& filter) const {
+  const WayPoint* ret   = nullptr;
+  float           qDist = maxDist<std::numeric_limits<float>::max() ? maxDist*maxDist : maxDist;
+  nearest(points.data(),points.size(),0,at,filter,ret,qDist);
+  return ret;
+  }
+
+void WayMatrix::KdTree::nearest(const WayPoint*const* v, size_t cnt, uint8_t axis, const Vec3& at,
+                                const std::function<bool(const WayPoint&)>& filter, const WayPoint*& ret, float& qDist) const {
+  if(cnt==0)
+    return;
+
+  const size_t    mid  = cnt/2;
+  const WayPoint& w    = *v[mid];
+  const float     l    = (w.position()-at).quadLength();
+  // filter can be expensive (ray-test), so it's tested only for a better candidate
+  if(l<qDist && filter(w)) {
+    ret   = &w;
+    qDist = l;
+    }
+
+  const uint8_t next  = uint8_t((axis+1)%3);
+  const float   delta = component(at,axis) - component(w.position(),axis);
+  if(delta<0) {
+    nearest(v,mid,next,at,filter,ret,qDist);
+    if(delta*delta<qDist)
+      nearest(v+mid+1,cnt-mid-1,next,at,filter,ret,qDist);
+    } else {
+    nearest(v+mid+1,cnt-mid-1,next,at,filter,ret,qDist);
+    if(delta*delta<qDist)
+      nearest(v,mid,next,at,filter,ret,qDist);
+    }
+  }
+
+size_t WayMatrix::PathKeyHash::operator()(const PathKey& k) const {
+  size_t h = std::hash<uint32_t>()(k.end);
+  auto   mix = [&h](uint32_t v) { h ^= std::hash<uint32_t>()(v) + 0x9e3779b9 + (h<<6) + (h>>2); };
+  mix(uint32_t(k.exactX));
+  mix(uint32_t(k.exactY));
+  mix(uint32_t(k.exactZ));
+  for(auto i:k.begin)
+    mix(i);
+  return h;
+  }
+
+void WayMatrix::invalidatePathCache() {
+  std::lock_guard<std::mutex> guard(pathCache.sync);
+  pathCache.lru.clear();
+  pathCache.index.clear();
+  }
+
+uint32_t WayMatrix::wayPointId(const WayPoint* wp) const {
+  if(wayPoints.empty())
+    return uint32_t(-1);
+  intptr_t id = std::distance<const WayPoint*>(wayPoints.data(),wp);
+  if(id<0 || size_t(id)>=wayPoints.size())
+    return uint32_t(-1);
+  return uint32_t(id);
+  }
+
+WayMatrix::PathKey WayMatrix::mkPathKey(const uint32_t* begin, size_t beginSz, const Vec3& exactBegin, uint32_t end) const {
+  PathKey k;
+  k.end = end;
+  k.begin.assign(begin,begin+beginSz);
+  if(beginSz>1) {
+    // choice of first point depends on exact position; 50cm is good enough
+    static const float cell = 50.f;
+    k.exactX = int32_t(std::floor(exactBegin.x/cell));
+    k.exactY = int32_t(std::floor(exactBegin.y/cell));
+    k.exactZ = int32_t(std::floor(exactBegin.z/cell));
+    }
+  return k;
+  }
 
-  const WayPoint* ret=nullptr;
-  auto  count = std::distance(b,e);(void) count;
-  float dist  = R*R;
-  for(auto i=b;i!=e;++i){
-    auto& w  = **i;
-    float dx = w.x-x;
-    float dy = w.y-y;
-    float dz = w.z-z;
-    float l  = dx*dx+dy*dy+dz*dz;
-    if(l>dist || dz*dz>300*300)
+bool WayMatrix::findPath(const uint32_t* begin, size_t beginSz, const Vec3& exactBegin, uint32_t end,
+                         std::vector<uint32_t>& path) const {
+  // A* search state is per-thread, so many npc's can path-find in parallel
+  struct Node {
+    uint32_t gen    = 0;
+    uint32_t parent = uint32_t(-1);
+    int32_t  len    = 0;
+    bool     closed = false;
+    };
+  struct Open {
+    int32_t  cost = 0;
+    uint32_t id   = 0;
+    bool operator < (const Open& other) const { return cost>other.cost; }
+    };
+  static thread_local std::vector<Node> node;
+  static thread_local std::vector<Open> open;
+  static thread_local uint32_t          gen = 0;
+
+  if(node.size()<wayPoints.size())
+    node.resize(wayPoints.size());
+  if(++gen==0) {
+    for(auto& i:node)
+      i.gen = 0;
+    gen = 1;
+    }
+  open.clear();
+
+  // same metric as edge length (WayPoint::connect), scaled to stay admissible and consistent
+  const WayPoint& target    = wayPoints[end];
+  auto            heuristic = [&](uint32_t id) {
+    return int32_t(heuristicScale*std::sqrt(wayPoints[id].qDistTo(target.x,target.y,target.z)));
+    };
+
+  for(size_t i=0; i<beginSz; ++i) {
+    const uint32_t id  = begin[i];
+    const int32_t  len = int32_t((exactBegin - wayPoints[id].position()).length());
+    auto&          n   = node[id];
+    if(n.gen==gen && n.len<=len)
       continue;
-    if(!filter(w))
+    n.gen    = gen;
+    n.parent = uint32_t(-1);
+    n.len    = len;
+    n.closed = false;
+    open.push_back({len+heuristic(id),id});
+    std::push_heap(open.begin(),open.end());
+    }
+
+  while(!open.empty()) {
+    std::pop_heap(open.begin(),open.end());
+    const uint32_t id = open.back().id;
+    open.pop_back();
+
+    auto& n = node[id];
+    if(n.closed)
       continue;
-    ret  = &w;
-    dist = l;
+    n.closed = true;
+    if(id==end)
+      break;
+
+    for(auto& c:wayPoints[id].connections()) {
+      const uint32_t cid = uint32_t(std::distance<const WayPoint*>(wayPoints.data(),c.point));
+      const int32_t  len = n.len + c.len;
+      auto&          cn  = node[cid];
+      if(cn.gen==gen && (cn.closed || cn.len<=len))
+        continue;
+      cn.gen    = gen;
+      cn.parent = id;
+      cn.len    = len;
+      cn.closed = false;
+      open.push_back({len+heuristic(cid),cid});
+      std::push_heap(open.begin(),open.end());
+      }
     }
-  return ret;
+
+  if(node[end].gen!=gen || !node[end].closed)
+    return false;
+
+  // path is stored from end to begin - same order, as WayPath expects
+  path.clear();
+  for(uint32_t id=end; id!=uint32_t(-1); id=node[id].parent)
+    path.push_back(id);
+  return true;
   }
 
 WayPath WayMatrix::wayTo(const WayPoint** begin, size_t beginSz, const Tempest::Vec3 exactBegin, const WayPoint& end) const {
   if(beginSz==0)
     return WayPath();
 
-  intptr_t endId = std::distance<const WayPoint*>(&wayPoints[0],&end);
-  if(endId<0 || size_t(endId)>=wayPoints.size()){
+  const uint32_t endId = wayPointId(&end);
+  if(endId==uint32_t(-1)) {
     if(end.name.find("FP_")==0) {
       WayPath ret;
       ret.add(end);
@@ -296,75 +465,47 @@ WayPath WayMatrix::wayTo(const WayPoint** begin, size_t beginSz, const Tempest::
     return WayPath();
     }
 
-  pathGen++;
-  if(pathGen==1){
-    // new cycle
-    for(auto& i:wayPoints)
-      i.pathGen=0;
+  std::vector<uint32_t> beginId;
+  beginId.reserve(beginSz);
+  for(size_t i=0; i<beginSz; ++i) {
+    const uint32_t id = wayPointId(begin[i]);
+    if(id!=uint32_t(-1))
+      beginId.push_back(id);
     }
+  if(beginId.empty())
+    return WayPath();
 
-  std::vector<const WayPoint*> *front=&stk[0], *back=&stk[1];
-  stk[0].clear();
-  stk[1].clear();
-
-  end.pathLen = 0;
-  end.pathGen = pathGen;
-  front->push_back(&end);
-
-  while(front->size()>0) {
-    bool done = true;
-    for(size_t i=0; i<beginSz; ++i)
-      if(begin[i]->pathGen!=pathGen) {
-        done = false;
-        break;
-        }
-    if(done)
-      break;
-
-    for(auto& wp:*front) {
-      int32_t l0 = wp->pathLen;
-
-      for(auto i:wp->connections()){
-        auto& w  = *i.point;
-        int32_t l1 = l0+i.len;
-        if(w.pathGen!=pathGen || w.pathLen>l1){
-          w.pathLen = l1;
-          w.pathGen = pathGen;
-          back->push_back(&w);
-          }
-        }
+  static const size_t   maxCacheSize = 256;
+  const PathKey         key          = mkPathKey(beginId.data(),beginId.size(),exactBegin,endId);
+  std::vector<uint32_t> path;
+  bool                  cached       = false;
+  {
+    std::lock_guard<std::mutex> guard(pathCache.sync);
+    auto it = pathCache.index.find(key);
+    if(it!=pathCache.index.end()) {
+      pathCache.lru.splice(pathCache.lru.begin(),pathCache.lru,it->second);
+      path   = it->second->second;
+      cached = true;
       }
-    std::swap(front,back);
-    back->clear();
-    }
-
-  const WayPoint* first = begin[0];
-  for(size_t i=0; i<beginSz; ++i) {
-    int32_t iLen = begin[i]->pathLen + int((exactBegin - begin[i]->position()).length());
-    int32_t fLen = first   ->pathLen + int((exactBegin - first   ->position()).length());
-    if(iLen<fLen)
-      first = begin[i];
-    }
+  }
 
-  WayPath ret;
-  ret.add(*first);
-  const WayPoint* current = first;
-  while(current!=&end) {
-    int32_t l0 = current->pathLen, l1=l0;
-
-    const WayPoint* next=nullptr;
-    for(auto i:current->connections()){
-      if(i.point->pathGen==pathGen && i.point->pathLen+i.len<=l0 && i.point->pathLen<l1){
-        next = i.point;
-        l1   = i.point->pathLen;
+  if(!cached) {
+    if(!findPath(beginId.data(),beginId.size(),exactBegin,endId,path))
+      path.clear();
+
+    std::lock_guard<std::mutex> guard(pathCache.sync);
+    if(pathCache.index.find(key)==pathCache.index.end()) {
+      pathCache.lru.emplace_front(key,path);
+      pathCache.index[key] = pathCache.lru.begin();
+      if(pathCache.lru.size()>maxCacheSize) {
+        pathCache.index.erase(pathCache.lru.back().first);
+        pathCache.lru.pop_back();
         }
       }
-    if(next==nullptr)
-      return WayPath();
-    ret.add(*next);
-    current=next;
-    }
+  }
 
-  ret.reverse();
+  WayPath ret;
+  for(auto id:path)
+    ret.add(wayPoints[id]);
   return ret;
   }
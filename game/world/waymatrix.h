@@ -6,7 +6,12 @@
 #include <zenkit/world/WayNet.hh>
 
 #include <vector>
+#include <list>
+#include <unordered_map>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 #include "waypath.h"
 #include "waypoint.h"
@@ -37,6 +42,7 @@ class WayMatrix final {
   private:
     World&                 world;
     float                  distanceThreshold = 20.f*100.f;
+    float                  heuristicScale    = 0.f; // A*: scale of distance to target
 
     std::vector<zenkit::WayEdge> edges;
 
@@ -44,19 +50,56 @@ class WayMatrix final {
     std::vector<WayPoint>  freePoints, startPoints;
     std::vector<WayPoint*> indexPoints;
 
-    std::vector<WayPoint*> fpInd;
+    // implicit k-d tree: median of each range is a node, split axis cycles x,y,z
+    class KdTree final {
+      public:
+        void            build(std::vector<const WayPoint*>&& pt);
+        const WayPoint* nearest(const Tempest::Vec3& at, float maxDist, const std::function<bool(const WayPoint&)>& filter) const;
+        size_t          size() const { return points.size(); }
+
+      private:
+        std::vector<const WayPoint*> points;
+
+        void build  (const WayPoint** v, size_t cnt, uint8_t axis);
+        void nearest(const WayPoint*const* v, size_t cnt, uint8_t axis, const Tempest::Vec3& at,
+                     const std::function<bool(const WayPoint&)>& filter, const WayPoint*& ret, float& qDist) const;
+      };
+
+    KdTree                 wayTree;
+    KdTree                 indexTree;
 
     struct FpIndex {
       std::string                  key;
-      std::vector<const WayPoint*> index;
+      KdTree                       index;
       };
-    mutable std::vector<FpIndex>          fpIndex;
-
-    mutable uint16_t                      pathGen=0;
-    mutable std::vector<const WayPoint*>  stk[2];
+    mutable std::shared_mutex                     fpSync;
+    mutable std::vector<std::unique_ptr<FpIndex>> fpIndex;
+
+    struct PathKey {
+      uint32_t              end = 0;
+      int32_t               exactX = 0, exactY = 0, exactZ = 0;
+      std::vector<uint32_t> begin;
+      bool operator == (const PathKey& other) const = default;
+      };
+    struct PathKeyHash {
+      size_t operator()(const PathKey& k) const;
+      };
+    struct PathCache {
+      using Entry = std::pair<PathKey,std::vector<uint32_t>>;
+      std::mutex                                                                    sync;
+      std::list<Entry>                                                              lru;
+      std::unordered_map<PathKey,std::list<Entry>::iterator,PathKeyHash>            index;
+      };
+    mutable PathCache                     pathCache;
 
     void                   adjustWaypoints(std::vector<WayPoint> &wp);
     void                   calculateLadderPoints();
+    void                   invalidatePathCache();
+
+    uint32_t               wayPointId(const WayPoint* wp) const;
+    PathKey                mkPathKey(const uint32_t* begin, size_t beginSz, const Tempest::Vec3& exactBegin, uint32_t end) const;
+    bool                   findPath(const uint32_t* begin, size_t beginSz, const Tempest::Vec3& exactBegin, uint32_t end,
+                                    std::vector<uint32_t>& path) const;
 
     const FpIndex&         findFpIndex(std::string_view name) const;
     const WayPoint*        findFreePoint(float x, float y, float z, const FpIndex &ind,
@@ -1,8 +1,12 @@
 #include "world.h"
 
 #include <functional>
+#include <chrono>
 #include <future>
 #include <cctype>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 
 #include <Tempest/Log>
 #include <Tempest/Painter>
@@ -15,9 +19,13 @@
 #include "world/objects/interactive.h"
 #include "world/triggers/abstracttrigger.h"
 #include "world/triggers/cscamera.h"
+#include "world/landscapecache.h"
 #include "game/globaleffects.h"
 #include "game/serialize.h"
 #include "utils/string_frm.h"
+#include "utils/fileext.h"
+#include "utils/profiler.h"
+#include "utils/workers.h"
 #include "gothic.h"
 #include "focus.h"
 #include "resources.h"
@@ -63,6 +71,14 @@ const char* materialTag(zenkit::MaterialGroup src) {
   return "UD";
   }
 
+// assets, that are referenced by vob tree; decoded upfront on workers, before serial vob construction
+struct World::VobAssets {
+  std::unordered_set<std::string> meshes;
+  std::unordered_set<std::string> textures;
+  std::vector<size_t>             rootSize;
+  size_t                          vobCount = 0;
+  };
+
 World::World(GameSession& game, std::string_view file, bool startup, std::function<void(int)> loadProgress)
   :wname(std::move(file)), game(game), wsound(game,*this), wobj(*this) {
   const auto* entry = Resources::vdfsIndex().find(wname);
@@ -72,26 +88,69 @@ World::World(GameSession& game, std::string_view file, bool startup, std::functi
     return;
     }
 
+  /* loading stages:
+   *   zen  -> { bvh, landscape, waynet, assets } -> vobs -> waynet index
+   * bvh and packed landscape are taken from on-disk cache, if zen-file is unchanged;
+   * vob construction registers objects in world/physics/renderer, and stays serial;
+   * all asset decoding it needs is done by 'assets' stage in parallel.
+   */
   try {
-    auto          buf = entry->open_read();
-    zenkit::World world;
+    auto           buf = entry->open_read();
+    LandscapeCache cache(wname,*buf);
+    zenkit::World  world;
     world.load(buf.get(), version().game == 1 ? zenkit::GameVersion::GOTHIC_1
                                               : zenkit::GameVersion::GOTHIC_2);
-
     loadProgress(20);
     auto& worldMesh = world.world_mesh;
 
     auto wdynamicFut = std::async(std::launch::async, [&]() {
       Workers::setThreadName("Loading: BVH thread");
-      return std::unique_ptr<DynamicWorld>(new DynamicWorld(*this,worldMesh));
+      return std::unique_ptr<DynamicWorld>(new DynamicWorld(*this,worldMesh,cache));
       });
     auto wviewFut = std::async(std::launch::async, [&]() {
       Workers::setThreadName("Loading: PackedMesh thread");
-      PackedMesh vmesh(worldMesh,PackedMesh::PK_VisualLnd);
+      PackedMesh vmesh;
+      if(!cache.loadMesh(vmesh,worldMesh)) {
+        vmesh = PackedMesh(worldMesh,PackedMesh::PK_VisualLnd);
+        cache.saveMesh(vmesh);
+        }
       return std::unique_ptr<WorldView>(new WorldView(*this,vmesh));
       });
 
-    loadProgress(30);
+    // Workers jobs reference locals of this scope and don't join on destruction: wait for them on any exit
+    VobAssets                                   assets;
+    std::atomic<size_t>                         assetsDone{0};
+    Workers::Future<std::unique_ptr<WayMatrix>> wmatrixFut;
+    Workers::Future<void>                       assetsFut;
+    struct Join {
+      Workers::Task* task[2];
+      ~Join() {
+        for(auto t:task) {
+          try {
+            t->wait();
+            }
+          catch(...) {
+            // error is reported by get()
+            }
+          }
+        }
+      } join{{&wmatrixFut,&assetsFut}};
+
+    wmatrixFut = Workers::async([&]() {
+      return std::unique_ptr<WayMatrix>(new WayMatrix(*this,world.world_way_net));
+      });
+
+    assets.rootSize.reserve(world.world_vobs.size());
+    for(auto& vob:world.world_vobs) {
+      size_t cnt = vob==nullptr ? 0 : collectAssets(*vob,assets);
+      assets.rootSize.push_back(cnt);
+      assets.vobCount += cnt;
+      }
+
+    const size_t assetsTotal = assets.meshes.size() + assets.textures.size();
+    assetsFut = Workers::async([&assets,&assetsDone]() {
+      prefetchAssets(assets,assetsDone);
+      });
 
     {
       bsp.nodes             = std::move(world.world_bsp_tree.nodes);
@@ -100,18 +159,33 @@ World::World(GameSession& game, std::string_view file, bool startup, std::functi
       bsp.sectorsData.resize(bsp.sectors.size());
       world.world_bsp_tree  = zenkit::BspTree();
     }
-    loadProgress(50);
-
-    wview = wviewFut.get();
-    loadProgress(60);
 
+    // [20..70]: concurrent stages; assets are weighted by count, other stages are a step each
+    auto isReady = [](auto& f) { return f.wait_for(std::chrono::seconds(0))==std::future_status::ready; };
+    while(true) {
+      const size_t stages = (isReady(wdynamicFut) ? 1 : 0) + (isReady(wviewFut) ? 1 : 0) + (wmatrixFut.isDone() ? 1 : 0);
+      const size_t done   = assetsDone.load() + stages;
+      loadProgress(int(20 + (50*done)/(assetsTotal+3)));
+      if(stages==3 && assetsFut.isDone())
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    wview    = wviewFut.get();
     wdynamic = wdynamicFut.get();
+    wmatrix  = wmatrixFut.get();
+    assetsFut.get();
     loadProgress(70);
 
+    // [70..95]: vob tree
     globFx.reset(new GlobalEffects(*this));
-    wmatrix.reset(new WayMatrix(*this,world.world_way_net));
-    for(auto& vob:world.world_vobs)
-      wobj.addRoot(vob,startup);
+    size_t vobsDone = 0;
+    for(size_t i=0; i<world.world_vobs.size(); ++i) {
+      wobj.addRoot(world.world_vobs[i],startup);
+      vobsDone += assets.rootSize[i];
+      if(assets.vobCount>0 && (i%64)==0)
+        loadProgress(int(70 + (25*vobsDone)/assets.vobCount));
+      }
+    loadProgress(95);
 
     wmatrix->buildIndex();
     loadProgress(100);
@@ -122,6 +196,58 @@ World::World(GameSession& game, std::string_view file, bool startup, std::functi
     }
   }
 
+size_t World::collectAssets(const zenkit::VirtualObject& vob, VobAssets& out) {
+  size_t count = 1;
+  if(vob.visual!=nullptr && !vob.visual->name.empty()) {
+    auto& name = vob.visual->name;
+    switch(vob.visual->type) {
+      case zenkit::VisualType::MESH:
+      case zenkit::VisualType::MULTI_RESOLUTION_MESH:
+        out.meshes.insert(name);
+        break;
+      case zenkit::VisualType::MODEL:
+      case zenkit::VisualType::MORPH_MESH: {
+        // same as ObjVisual::setVisual
+        auto visual = name;
+        FileExt::exchangeExt(visual,"ASC","MDL");
+        out.meshes.insert(std::move(visual));
+        break;
+        }
+      case zenkit::VisualType::DECAL:
+        out.textures.insert(name);
+        break;
+      default:
+        break;
+      }
+    }
+  for(auto& i:vob.children)
+    if(i!=nullptr)
+      count += collectAssets(*i,out);
+  return count;
+  }
+
+void World::prefetchAssets(const VobAssets& assets, std::atomic<size_t>& done) {
+  // meshes are loaded with their textures; failures are reported again by actual user
+  std::vector<const std::string*> names;
+  names.reserve(assets.meshes.size() + assets.textures.size());
+  for(auto& i:assets.meshes)
+    names.push_back(&i);
+  const size_t meshCount = names.size();
+  for(auto& i:assets.textures)
+    names.push_back(&i);
+
+  Workers::parallelTasks(names.size(),[&](size_t i) {
+    try {
+      if(i<meshCount)
+        Resources::loadMesh(*names[i]); else
+        Resources::loadTexture(*names[i]);
+      }
+    catch(...) {
+      }
+    done.fetch_add(1,std::memory_order_relaxed);
+    });
+  }
+
 World::~World() {
   }
 
@@ -290,6 +416,7 @@ LightGroup::Light World::addLight(std::string_view preset) {
   }
 
 void World::updateAnimation(uint64_t dt) {
+  Profiler::Zone zone("World::updateAnimation");
   wobj.updateAnimation(dt);
   }
 
@@ -374,15 +501,35 @@ void World::scaleTime(uint64_t& dt) {
   }
 
 void World::tick(uint64_t dt) {
+  Profiler::Zone zone("World::tick");
   static bool doTicks=true;
   if(!doTicks)
     return;
+  using namespace std::chrono;
+  auto t0 = steady_clock::now();
   wobj.tick(dt,dt);
+  auto t1 = steady_clock::now();
   wdynamic->tick(dt);
+  auto t2 = steady_clock::now();
   wview->tick(dt);
+  auto t3 = steady_clock::now();
   if(auto pl = player())
     wsound.tick(*pl);
+  auto t4 = steady_clock::now();
   globFx->tick(dt);
+  auto t5 = steady_clock::now();
+
+  timings.objects += uint64_t(duration_cast<microseconds>(t1-t0).count());
+  timings.physics += uint64_t(duration_cast<microseconds>(t2-t1).count());
+  timings.view    += uint64_t(duration_cast<microseconds>(t3-t2).count());
+  timings.sound   += uint64_t(duration_cast<microseconds>(t4-t3).count());
+  timings.effects += uint64_t(duration_cast<microseconds>(t5-t4).count());
+  }
+
+World::TickTimings World::takeTickTimings() {
+  auto ret = timings;
+  timings  = TickTimings();
+  return ret;
   }
 
 uint64_t World::tickCount() const {
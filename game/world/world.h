@@ -5,6 +5,7 @@
 #include <Tempest/Matrix4x4>
 #include <string>
 #include <functional>
+#include <atomic>
 
 #include <zenkit/World.hh>
 
@@ -30,6 +31,15 @@ class GlobalFx;
 
 class World final {
   public:
+    // time spent by tick() in each subsystem, microseconds
+    struct TickTimings final {
+      uint64_t objects = 0;
+      uint64_t physics = 0;
+      uint64_t view    = 0;
+      uint64_t sound   = 0;
+      uint64_t effects = 0;
+      };
+
     World()=delete;
     World(const World&)=delete;
     World(GameSession& game, std::string_view file, bool startup, std::function<void(int)> loadProgress);
@@ -112,6 +122,7 @@ class World final {
 
     void                 scaleTime(uint64_t& dt);
     void                 tick(uint64_t dt);
+    auto                 takeTickTimings() -> TickTimings;
     uint64_t             tickCount() const;
     void                 setDayTime(int32_t h,int32_t min);
     gtime                time() const;
@@ -211,11 +222,16 @@ class World final {
     WorldSound                            wsound;
     WorldObjects                          wobj;
     std::unique_ptr<Npc>                  lvlInspector;
+    TickTimings                           timings;
 
     auto         roomAt(const zenkit::BspNode &node) -> std::string_view;
     auto         portalAt(std::string_view tag) -> BspSector*;
 
     void         initScripts(bool firstTime);
 
+    struct VobAssets;
+    static size_t collectAssets(const zenkit::VirtualObject& vob, VobAssets& out);
+    static void   prefetchAssets(const VobAssets& assets, std::atomic<size_t>& done);
+
     Sound        addHitEffect(std::string_view src, std::string_view reciver, std::string_view scheme, const Tempest::Matrix4x4& pos);
   };
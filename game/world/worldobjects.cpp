@@ -11,9 +11,12 @@
 #include "world/triggers/triggerworldstart.h"
 #include "world/triggers/abstracttrigger.h"
 #include "world.h"
+#include "graphics/dynamic/frustrum.h"
 #include "utils/workers.h"
 #include "utils/dbgpainter.h"
+#include "utils/profiler.h"
 #include "gothic.h"
+#include "camera.h"
 
 #include <Tempest/Painter>
 #include <Tempest/Application>
@@ -73,7 +76,14 @@ void WorldObjects::load(Serialize &fin) {
   fin.setVersion(v);
   }
   itemArr.clear();
+  itmIndex.invalidate();
   items.clear();
+  npcGrid.clear();
+  npcActive.clear();
+  npcNear.clear();
+
+  // npc entries are unpacked upfront on workers; Npc::load itself touches script-vm and stays serial
+  fin.prefetch("worlds/",fin.worldName(),"/npc/");
 
   uint32_t sz = fin.directorySize("worlds/",fin.worldName(),"/npc/");
   npcArr.resize(sz);
@@ -81,6 +91,7 @@ void WorldObjects::load(Serialize &fin) {
     npcArr[i] = std::make_unique<Npc>(owner,size_t(-1),"");
   for(size_t i=0; i<npcArr.size(); ++i) {
     npcArr[i]->load(fin,i);
+    trackNpc(*npcArr[i]);
     }
 
   fin.setEntry("worlds/",fin.worldName(),"/items");
@@ -116,9 +127,15 @@ void WorldObjects::save(Serialize &fout) {
   fout.setEntry("worlds/",fout.worldName(),"/version");
   fout.write(Serialize::Version::Current);
 
-  for(size_t i=0; i<npcArr.size(); ++i) {
-    npcArr[i]->save(fout,i);
-    }
+  std::vector<Serialize> npcData;
+  npcData.reserve(npcArr.size());
+  for(size_t i=0; i<npcArr.size(); ++i)
+    npcData.emplace_back(fout.fork());
+  Workers::parallelTasks(npcArr.size(),[this,&npcData](size_t i){
+    npcArr[i]->save(npcData[i],i);
+    });
+  for(auto& i:npcData)
+    fout.merge(std::move(i));
 
   fout.setEntry("worlds/",fout.worldName(),"/items");
   uint32_t sz = uint32_t(itemArr.size());
@@ -142,6 +159,7 @@ void WorldObjects::save(Serialize &fout) {
   }
 
 void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
+  Profiler::Zone zone("WorldObjects::tick");
   auto passive=std::move(sndPerc);
   sndPerc.clear();
 
@@ -159,6 +177,7 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
     std::sort(npcArr.begin(),npcArr.end(),[](std::unique_ptr<Npc>& a, std::unique_ptr<Npc>& b){
       return a->handle().id<b->handle().id;
       });
+    npcIndex.invalidate();
     }
 
   auto       camera  = Gothic::inst().camera();
@@ -204,25 +223,7 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
   if(pl==nullptr)
     return;
 
-  npcNear.clear();
-  //const int   PERC_DIST_INTERMEDIAT = 1000;
-  const float nearDist              = 3000*3000;
-  const float farDist               = 6000*6000;
-
-  auto plPos = pl->position();
-  for(auto& i:npcArr) {
-    float dist = (i->position()-plPos).quadLength();
-    if(dist<nearDist){
-      npcNear.push_back(i.get());
-      if(i.get()!=pl)
-        i->setProcessPolicy(Npc::ProcessPolicy::AiNormal);
-      } else
-    if(dist<farDist) {
-      i->setProcessPolicy(Npc::ProcessPolicy::AiFar);
-      } else {
-      i->setProcessPolicy(Npc::ProcessPolicy::AiFar2);
-      }
-    }
+  updateProcessPolicy(*pl);
   tickNear(dt);
   for(CollisionZone* z:collisionZn)
     z->tick(dt);
@@ -245,30 +246,71 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
     }
   }
 
+void WorldObjects::updateProcessPolicy(Npc& pl) {
+  //const int   PERC_DIST_INTERMEDIAT = 1000;
+  const float nearDist              = 3000*3000;
+  const float farDist               = 6000;
+
+  // everything, that is not found around the player, is AiFar2
+  for(auto i:npcActive)
+    if(i!=&pl)
+      i->setProcessPolicy(Npc::ProcessPolicy::AiFar2);
+
+  npcActive.clear();
+  npcGrid.find(pl.position(),farDist,[this](Npc& npc) {
+    npcActive.push_back(&npc);
+    });
+  // keep same order as in npcArr: script id is not unique, so sort by position in npcArr
+  std::sort(npcActive.begin(),npcActive.end(),[this](Npc* a, Npc* b){
+    return npcId(a)<npcId(b);
+    });
+
+  npcNear.clear();
+  auto plPos = pl.position();
+  for(auto i:npcActive) {
+    float dist = (i->position()-plPos).quadLength();
+    if(dist<nearDist){
+      npcNear.push_back(i);
+      if(i!=&pl)
+        i->setProcessPolicy(Npc::ProcessPolicy::AiNormal);
+      } else {
+      i->setProcessPolicy(Npc::ProcessPolicy::AiFar);
+      }
+    }
+  }
+
+void WorldObjects::trackNpc(Npc& npc) {
+  npcIndex.invalidate();
+  npcGrid.insert(npc);
+  // new npc is classified on next tick
+  npcActive.push_back(&npc);
+  }
+
+void WorldObjects::untrackNpc(Npc& npc) {
+  npcIndex.invalidate();
+  npcGrid.erase(npc);
+  npcActive.erase(std::remove(npcActive.begin(),npcActive.end(),&npc),npcActive.end());
+  npcNear  .erase(std::remove(npcNear  .begin(),npcNear  .end(),&npc),npcNear  .end());
+  }
+
 uint32_t WorldObjects::npcId(const Npc *ptr) const {
-  if(ptr==nullptr)
-    return uint32_t(-1);
-  for(size_t i=0;i<npcArr.size();++i)
-    if(npcArr[i].get()==ptr)
-      return uint32_t(i);
-  return uint32_t(-1);
+  return npcIndex.find(ptr,npcArr.size(),[this](size_t i) -> const void* {
+    return npcArr[i].get();
+    });
   }
 
 uint32_t WorldObjects::itmId(const void *ptr) const {
-  for(size_t i=0;i<itemArr.size();++i)
-    if(&itemArr[i]->handle()==ptr)
-      return uint32_t(i);
-  return uint32_t(-1);
+  // NOTE: key is script-handle of item
+  return itmIndex.find(ptr,itemArr.size(),[this](size_t i) -> const void* {
+    return &itemArr[i]->handle();
+    });
   }
 
 uint32_t WorldObjects::mobsiId(const void* ptr) const {
-  uint32_t ret=0;
-  for(auto& i:interactiveObj) {
-    if(i==ptr)
-      return ret;
-    ++ret;
-    }
-  return uint32_t(-1);
+  auto arr = interactiveObj.begin();
+  return mobsiIndex.find(ptr,interactiveObj.size(),[arr](size_t i) -> const void* {
+    return arr[i];
+    });
   }
 
 Npc* WorldObjects::addNpc(size_t npcInstance, std::string_view at) {
@@ -301,6 +343,7 @@ Npc* WorldObjects::addNpc(size_t npcInstance, std::string_view at) {
     npc->attachToPoint(pos);
     npc->updateTransform();
     npcArr.emplace_back(npc);
+    trackNpc(*npc);
     } else {
     auto& point = owner.deadPoint();
     npc->attachToPoint(nullptr);
@@ -324,6 +367,7 @@ Npc* WorldObjects::addNpc(size_t npcInstance, const Vec3& pos) {
   npc->updateTransform();
 
   npcArr.emplace_back(npc);
+  trackNpc(*npc);
   return npc;
   }
 
@@ -345,19 +389,18 @@ Npc* WorldObjects::insertPlayer(std::unique_ptr<Npc> &&npc, std::string_view at)
   npc->attachToPoint(pos);
   npc->updateTransform();
   npcArr.emplace_back(std::move(npc));
+  trackNpc(*npcArr.back());
   return npcArr.back().get();
   }
 
 std::unique_ptr<Npc> WorldObjects::takeNpc(const Npc* ptr) {
-  for(size_t i=0; i<npcArr.size(); ++i){
-    auto& npc=*npcArr[i];
-    if(&npc==ptr){
-      auto ret=std::move(npcArr[i]);
-      npcArr.erase(npcArr.begin() + int32_t(i));
-      return ret;
-      }
-    }
-  return nullptr;
+  const uint32_t i = npcId(ptr);
+  if(i==uint32_t(-1))
+    return nullptr;
+  untrackNpc(*npcArr[i]);
+  auto ret=std::move(npcArr[i]);
+  npcArr.erase(npcArr.begin() + int32_t(i));
+  return ret;
   }
 
 void WorldObjects::removeNpc(Npc& npc) {
@@ -424,12 +467,50 @@ void WorldObjects::updateAnimation(uint64_t dt) {
     return;
   if(dt==0)
     return;
-  Workers::parallelTasks(npcArr,[dt](std::unique_ptr<Npc>& i){
-    i->updateAnimation(dt);
+
+  // animation LOD: far away and off-screen objects are updated at reduced rate
+  const uint64_t frame  = animFrame++;
+  auto           camera = Gothic::inst().camera();
+  Frustrum       fr;     // default frustrum accepts everything
+  Vec3           eye    = {};
+  if(camera!=nullptr) {
+    fr.make(camera->viewProj(),0,0);
+    eye = camera->listenerPosition().pos;
+    }
+
+  auto mobsi = Workers::async([this,dt,frame,&fr,eye]() {
+    interactiveObj.parallelFor([dt,frame,&fr,eye](Interactive& i){
+      const auto  pos  = i.position();
+      const float dist = (pos-eye).quadLength();
+      const bool  vis  = fr.testPoint(pos,lodRadius);
+      // never frozen: physics of mobsi follows the pose
+      AnimationLod::Level lod = AnimationLod::Full;
+      if(dist>=lodFarDist*lodFarDist)
+        lod = vis ? AnimationLod::Half : AnimationLod::Quarter; else
+      if(dist>=lodNearDist*lodNearDist)
+        lod = vis ? AnimationLod::Full : AnimationLod::Half;
+      i.updateAnimation(dt,lod,frame);
+      });
     });
-  interactiveObj.parallelFor([dt](Interactive& i){
-    i.updateAnimation(dt);
+  Workers::parallelTasks(npcArr,[dt,frame,&fr](std::unique_ptr<Npc>& i){
+    i->updateAnimation(dt,animationLod(*i,fr),frame);
     });
+  mobsi.wait();
+  }
+
+AnimationLod::Level WorldObjects::animationLod(const Npc& npc, const Frustrum& fr) {
+  const bool vis = fr.testPoint(npc.position(),lodRadius);
+  switch(npc.processPolicy()) {
+    case Npc::ProcessPolicy::Player:
+      return AnimationLod::Full;
+    case Npc::ProcessPolicy::AiNormal:
+      return vis ? AnimationLod::Full : AnimationLod::Half;
+    case Npc::ProcessPolicy::AiFar:
+      return vis ? AnimationLod::Half : AnimationLod::Quarter;
+    case Npc::ProcessPolicy::AiFar2:
+      return vis ? AnimationLod::Quarter : AnimationLod::Frozen;
+    }
+  return AnimationLod::Full;
   }
 
 bool WorldObjects::isTargeted(Npc& dst) {
@@ -488,22 +569,18 @@ void WorldObjects::detectNpcNear(const std::function<void(Npc&)>& f) {
 
 void WorldObjects::detectNpc(const float x, const float y, const float z,
                              const float r, const std::function<void(Npc&)>& f) {
-  float maxDist=r*r;
-  for(auto& i:npcArr) {
-    auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
-    if(qDist<maxDist)
-      f(*i);
-    }
+  npcGrid.find(Vec3(x,y,z),r,f);
   }
 
 void WorldObjects::detectItem(const float x, const float y, const float z,
                               const float r, const std::function<void(Item&)>& f) {
-  float maxDist=r*r;
-  for(auto& i:itemArr) {
-    auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
+  const Vec3  pos     = Vec3(x,y,z);
+  const float maxDist = r*r;
+  items.find(pos,r,[&](Item& i){
+    auto qDist = (i.position()-pos).quadLength();
     if(qDist<maxDist)
-      f(*i);
-    }
+      f(i);
+    });
   }
 
 void WorldObjects::addTrigger(AbstractTrigger* tg) {
@@ -595,17 +672,19 @@ Item* WorldObjects::addItem(const zenkit::VItem& vob) {
   }
 
 std::unique_ptr<Item> WorldObjects::takeItem(Item &it) {
-  for(auto& i:itemArr)
-    if(i.get()==&it){
-      auto ret=std::move(i);
-      i = std::move(itemArr.back());
-      itemArr.pop_back();
-      items.del(ret.get());
-      ret->setPhysicsDisable();
-      onItemRemoved(*ret);
-      return ret;
-      }
-  return nullptr;
+  const uint32_t id = itmId(&it.handle());
+  if(id==uint32_t(-1))
+    return nullptr;
+
+  auto& i   = itemArr[id];
+  auto  ret = std::move(i);
+  i = std::move(itemArr.back());
+  itemArr.pop_back();
+  itmIndex.invalidate();
+  items.del(ret.get());
+  ret->setPhysicsDisable();
+  onItemRemoved(*ret);
+  return ret;
   }
 
 void WorldObjects::removeItem(Item &it) {
@@ -666,6 +745,7 @@ Item* WorldObjects::addItem(size_t itemInstance, const Tempest::Vec3& pos, const
   std::unique_ptr<Item> ptr{new Item(owner,itemInstance,Item::T_World)};
   auto* it=ptr.get();
   itemArr.emplace_back(std::move(ptr));
+  itmIndex.invalidate();
   items.add(itemArr.back().get());
 
   it->setPosition (pos.x, pos.y, pos.z);
@@ -689,6 +769,7 @@ Item* WorldObjects::addItemDyn(size_t itemInstance, const Tempest::Matrix4x4& po
   auto* it=ptr.get();
   it->handle().owner = ownerNpc==size_t(-1) ? 0 : int32_t(ownerNpc);
   itemArr.emplace_back(std::move(ptr));
+  itmIndex.invalidate();
   items.add(itemArr.back().get());
 
   it->setObjMatrix(pos);
@@ -698,6 +779,7 @@ Item* WorldObjects::addItemDyn(size_t itemInstance, const Tempest::Matrix4x4& po
 
 void WorldObjects::addInteractive(Interactive* obj) {
   interactiveObj.add(obj);
+  mobsiIndex.invalidate();
   }
 
 void WorldObjects::addStatic(StaticObj* obj) {
@@ -723,10 +805,7 @@ Interactive* WorldObjects::validateInteractive(Interactive *def) {
 Npc *WorldObjects::validateNpc(Npc *def) {
   if(def==nullptr)
     return nullptr;
-  for(auto& i:npcArr)
-    if(i.get()==def)
-      return def;
-  return nullptr;
+  return npcId(def)!=uint32_t(-1) ? def : nullptr;
   }
 
 Item *WorldObjects::validateItem(Item *def) {
@@ -943,8 +1022,10 @@ void WorldObjects::resetPositionToTA() {
   for(auto& r:routines)
     r.curState = 0;
 
-  for(auto& i:npcInvalid)
+  for(auto& i:npcInvalid) {
+    trackNpc(*i);
     npcArr.push_back(std::move(i));
+    }
   npcInvalid.clear();
 
   for(size_t i=0;i<npcArr.size();) {
@@ -952,6 +1033,7 @@ void WorldObjects::resetPositionToTA() {
     if(n.resetPositionToTA()){
       ++i;
       } else {
+      untrackNpc(n);
       npcInvalid.emplace_back(std::move(npcArr[i]));
       npcArr.erase(npcArr.begin()+int(i));
 
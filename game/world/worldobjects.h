@@ -7,6 +7,9 @@
 
 #include "bullet.h"
 #include "spaceindex.h"
+#include "npcgrid.h"
+#include "animationlod.h"
+#include "utils/ptrindex.h"
 #include "game/gametime.h"
 #include "game/perceptionmsg.h"
 #include "game/constants.h"
@@ -22,6 +25,7 @@ class TriggerEvent;
 class AbstractTrigger;
 class CsCamera;
 class CollisionZone;
+class Frustrum;
 
 class WorldObjects final {
   public:
@@ -155,6 +159,10 @@ class WorldObjects final {
       uint64_t timeUntil = 0;
       };
 
+    static constexpr float             lodRadius   = 300;  // bounding sphere used for visibility test
+    static constexpr float             lodNearDist = 3000;
+    static constexpr float             lodFarDist  = 6000;
+
     World&                             owner;
 
     std::vector<CollisionZone*>        collisionZn;
@@ -170,10 +178,15 @@ class WorldObjects final {
     std::list<Bullet>                  bullets;
     std::vector<EffectState>           effects;
 
+    NpcGrid                            npcGrid;
     std::vector<std::unique_ptr<Npc>>  npcArr;
     std::vector<std::unique_ptr<Npc>>  npcInvalid; // dead or invalid TA
     std::vector<std::unique_ptr<Npc>>  npcRemoved; // removed, but may have a dangling references in game
     std::vector<Npc*>                  npcNear;
+    std::vector<Npc*>                  npcActive; // npc's with process-policy, other than AiFar2
+    PtrIndex                           npcIndex;
+    PtrIndex                           itmIndex;
+    PtrIndex                           mobsiIndex;
 
     std::vector<AbstractTrigger*>      triggers;
     std::vector<AbstractTrigger*>      triggersTk;
@@ -181,6 +194,7 @@ class WorldObjects final {
     std::vector<PerceptionMsg>         sndPerc;
     std::vector<TriggerEvent>          triggerEvents;
     CsCamera*                          currentCsCamera = nullptr;
+    uint64_t                           animFrame       = 0;
 
     template<class T>
     auto findObj(T &src, const Npc &pl, const SearchOpt& opt) -> typename std::remove_reference<decltype(src[0])>::type;
@@ -193,7 +207,12 @@ class WorldObjects final {
     void             setMobState(std::string_view scheme, int32_t st);
     void             passivePerceptionProcess(PerceptionMsg& msg, Npc& npc, Npc& pl);
 
+    void             trackNpc  (Npc& npc);
+    void             untrackNpc(Npc& npc);
+    void             updateProcessPolicy(Npc& pl);
+
     void             tickNear(uint64_t dt);
     void             tickTriggers(uint64_t dt);
     static bool      isTargetedBy(Npc& npc,Npc& by);
+    static auto      animationLod(const Npc& npc, const Frustrum& fr) -> AnimationLod::Level;
   };
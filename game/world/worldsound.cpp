@@ -337,12 +337,13 @@ bool WorldSound::isInListenerRange(const Tempest::Vec3& pos, float sndRgn) const
   }
 
 bool WorldSound::canSeeSource(const Tempest::Vec3& p) const {
-  auto dyn = owner.physic();
-  for(auto& i:effect3d) {
-    auto rc = dyn->ray(p, i->pos);
-    if(!rc.hasCol)
+  DynamicWorld::RayBatch rays;
+  for(auto& i:effect3d)
+    rays.add(p, i->pos);
+  owner.physic()->rayBatch(rays);
+  for(auto i:rays.hasCol)
+    if(!i)
       return true;
-    }
   return false;
   }
 